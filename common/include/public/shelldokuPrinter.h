@@ -1,13 +1,16 @@
 #pragma once
 
 #include "ansi.h"
+#include "sudokuHelpers.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <iostream>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace ShelldokuPrinter {
@@ -26,20 +29,24 @@ static bool CoutFilled{false};
 static void PrintSingle(const std::string_view &str);
 // Prepares the sudoku field, helper function
 static void PrepareSudokuField(std::size_t size);
+// Prints str on the line below the sudoku field and returns the cursor to the
+// field position (x, y)
+static void PrintBelowField(const std::string_view &str, std::size_t size,
+                            std::pair<unsigned int, unsigned int> position);
 
 static std::size_t FillCout(std::size_t size) {
   for (int r{}; r++ < size;) {
     for (int c{}; c++ < size;) {
       std::cout << "x";
-      if (c < size - 1 && c % (size / 3) == 0) {
+      if (c < size - 1 && c % SectionSizeOf(size) == 0) {
         std::cout << "o";
       }
     }
     std::cout << std::endl;
-    if (r < size - 1 && r % (size / 3) == 0) {
+    if (r < size - 1 && r % SectionSizeOf(size) == 0) {
       for (int div{}; div++ < size;) {
         std::cout << "o";
-        if (div < size - 1 && div % (size / 3) == 0) {
+        if (div < size - 1 && div % SectionSizeOf(size) == 0) {
           std::cout << "o";
         }
       }
@@ -59,16 +66,16 @@ static void PrintDividers(std::size_t size) {
   for (int r{}; r++ < size;) {
     for (int c{}; c++ < size;) {
       Ansi::MoveRight(1);
-      if (c < size - 1 && c % (size / 3) == 0) {
+      if (c < size - 1 && c % SectionSizeOf(size) == 0) {
         std::cout << "║";
       }
     }
     Ansi::MoveDown(1);
     Ansi::MoveLeft(size + 3);
-    if (r < size - 1 && r % (size / 3) == 0) {
+    if (r < size - 1 && r % SectionSizeOf(size) == 0) {
       for (int div{}; div++ < size;) {
         std::cout << "═";
-        if (div < size - 1 && div % (size / 3) == 0) {
+        if (div < size - 1 && div % SectionSizeOf(size) == 0) {
           std::cout << "╬";
         }
       }
@@ -81,7 +88,7 @@ static void PrintDividers(std::size_t size) {
 
 static void PrintSudoku(const std::vector<std::optional<unsigned int>> &values,
                         std::size_t size) {
-  const std::size_t sectionSize{size / 3};
+  const std::size_t sectionSize{SectionSizeOf(size)};
 
   for (std::size_t idx{}; idx < values.size(); idx++) {
     // vertical spaces
@@ -110,12 +117,15 @@ static void PrintSudoku(const std::vector<std::optional<unsigned int>> &values,
 static void
 PrintSingleLine(const std::vector<std::optional<unsigned int>> &values) {
   std::string str{};
+  // a divider after every row, a sudoku of size n has n * n values
+  const auto size{static_cast<std::size_t>(
+      std::lround(std::sqrt(static_cast<double>(values.size()))))};
   int idx{};
-  std::for_each(values.begin(), values.end(), [&str, &idx](auto v) {
+  std::for_each(values.begin(), values.end(), [&str, &idx, size](auto v) {
     std::string strV{(v.has_value() ? std::to_string(v.value()) : "0")};
     str += strV + " ";
     idx++;
-    if (!(idx % 9)) {
+    if (!(idx % size)) {
       str += "| ";
     }
   });
@@ -137,4 +147,24 @@ static void PrepareSudokuField(std::size_t size) {
   Ansi::SaveCursorPos();
 }
 
+static void PrintBelowField(const std::string_view &str, std::size_t size,
+                            std::pair<unsigned int, unsigned int> position) {
+  const std::size_t sectionSize{SectionSizeOf(size)};
+  Ansi::BackToSaved();
+  // rows + horizontal dividers
+  Ansi::MoveDown(size + sectionSize - 1);
+  // clears the rest of the line
+  std::cout << str << Ansi::ANSI_ESCAPE << "[K";
+  Ansi::BackToSaved();
+  // skips the dividers in front of the position, moving 0 would still move 1
+  const auto right{position.first + position.first / sectionSize};
+  const auto down{position.second + position.second / sectionSize};
+  if (right) {
+    Ansi::MoveRight(right);
+  }
+  if (down) {
+    Ansi::MoveDown(down);
+  }
+}
+
 }; // namespace ShelldokuPrinter
@@ -0,0 +1,88 @@
+#pragma once
+#include "sudokuSearchBudget.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// 9x9 bitboards: every board holds 1 bit per cell (81 bits, row major), bit
+// 0-63 in lo, bit 64-80 in hi. The solver keeps 1 board per value with the
+// cells that value can still go on.
+namespace bitboard {
+
+constexpr std::size_t Size{9};
+constexpr std::size_t SectionSize{3};
+constexpr std::size_t Cells{Size * Size};
+// rows, columns, squares
+constexpr std::size_t Units{3 * Size};
+
+struct Mask {
+  std::uint64_t lo{};
+  std::uint64_t hi{};
+};
+
+struct Tables {
+  std::array<Mask, Cells> cells{};
+  // every cell sharing a row, column or square with the cell
+  std::array<Mask, Cells> peers{};
+  std::array<Mask, Units> units{};
+  Mask all{};
+};
+
+[[nodiscard]] constexpr Mask CellMask(std::size_t cell) noexcept {
+  return cell < 64 ? Mask{std::uint64_t{1} << cell, 0}
+                   : Mask{0, std::uint64_t{1} << (cell - 64)};
+}
+
+[[nodiscard]] constexpr Mask Combine(Mask a, Mask b) noexcept {
+  return {a.lo | b.lo, a.hi | b.hi};
+}
+
+[[nodiscard]] constexpr Tables MakeTables() noexcept {
+  Tables tables{};
+  for (std::size_t cell{}; cell < Cells; cell++) {
+    const auto x{cell % Size};
+    const auto y{cell / Size};
+    const auto square{SectionSize * (y / SectionSize) + x / SectionSize};
+    tables.cells[cell] = CellMask(cell);
+    tables.all = Combine(tables.all, CellMask(cell));
+    tables.units[y] = Combine(tables.units[y], CellMask(cell));
+    tables.units[Size + x] = Combine(tables.units[Size + x], CellMask(cell));
+    tables.units[2 * Size + square] =
+        Combine(tables.units[2 * Size + square], CellMask(cell));
+  }
+  for (std::size_t cell{}; cell < Cells; cell++) {
+    const auto x{cell % Size};
+    const auto y{cell / Size};
+    const auto square{SectionSize * (y / SectionSize) + x / SectionSize};
+    auto peers{Combine(Combine(tables.units[y], tables.units[Size + x]),
+                       tables.units[2 * Size + square])};
+    peers.lo &= ~tables.cells[cell].lo;
+    peers.hi &= ~tables.cells[cell].hi;
+    tables.peers[cell] = peers;
+  }
+  return tables;
+}
+
+inline constexpr Tables BitboardTables{MakeTables()};
+
+// Solves the givens (0 is empty, 1-9 are values).
+// Writes the first solution and returns the amount of solutions up to limit.
+// Stops early when the budget says so
+using KernelFunction = std::size_t (*)(const std::uint8_t *givens,
+                                       std::uint8_t *solution,
+                                       std::size_t limit,
+                                       SearchBudget &budget) noexcept;
+
+std::size_t RunScalar(const std::uint8_t *givens, std::uint8_t *solution,
+                      std::size_t limit, SearchBudget &budget) noexcept;
+#if defined(SHELLDOKU_BITBOARD_X86)
+std::size_t RunSse41(const std::uint8_t *givens, std::uint8_t *solution,
+                     std::size_t limit, SearchBudget &budget) noexcept;
+std::size_t RunAvx2(const std::uint8_t *givens, std::uint8_t *solution,
+                    std::size_t limit, SearchBudget &budget) noexcept;
+#endif
+
+// Returns the fastest kernel the cpu supports
+[[nodiscard]] KernelFunction SelectKernel() noexcept;
+
+} // namespace bitboard
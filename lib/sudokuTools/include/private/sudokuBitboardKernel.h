@@ -0,0 +1,200 @@
+#pragma once
+#include "sudokuBitboard.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Only included by the kernel translation units, each compiled for its own
+// instruction set. The Ops type of every translation unit lives in an
+// anonymous namespace so the instantiations never mix.
+//
+// Ops provides:
+// Board                                 128 bit board type
+// Load(Mask), Zero()                    create boards
+// And(a, b), AndNot(a, b), Or(a, b)     a & b, a & ~b, a | b
+// IsZero(a), Popcount(a), LowestCell(a) queries
+// ClearCell(digits, cell)               removes cell from all 9 digit boards
+// Accumulate(digits, once, twice, thrice)
+//                                       cells with at least 1, 2, 3 candidates
+
+namespace bitboard {
+
+template <typename Ops> class Kernel {
+public:
+  using Board = typename Ops::Board;
+
+  std::size_t Run(const std::uint8_t *givens, std::uint8_t *solution_,
+                  std::size_t limit, SearchBudget &budget_) noexcept {
+    solution = solution_;
+    solutionLimit = limit;
+    solutionCount = 0;
+    pBudget = &budget_;
+    pendingNodes = 0;
+
+    auto &state{states[0]};
+    for (auto &digit : state.digits) {
+      digit = Ops::Load(BitboardTables.all);
+    }
+    state.solved = Ops::Zero();
+    for (std::size_t cell{}; cell < Cells; cell++) {
+      if (!givens[cell]) {
+        continue;
+      }
+      if (givens[cell] > Size || !Place(state, cell, givens[cell] - 1)) {
+        return 0;
+      }
+    }
+
+    if (limit && Propagate(state)) {
+      static_cast<void>(Search(0));
+    }
+    pBudget->Count(pendingNodes);
+    return solutionCount;
+  }
+
+private:
+  struct State {
+    Board digits[Size];
+    Board solved;
+  };
+
+  // Places the digit, removes the cell from all other digits and the digit
+  // from all peers
+  [[nodiscard]] static bool Place(State &state, std::size_t cell,
+                                  std::size_t digit) noexcept {
+    const auto cellBoard{Ops::Load(BitboardTables.cells[cell])};
+    if (Ops::IsZero(Ops::And(state.digits[digit], cellBoard))) {
+      return false;
+    }
+    Ops::ClearCell(state.digits, cellBoard);
+    state.digits[digit] =
+        Ops::Or(Ops::AndNot(state.digits[digit],
+                            Ops::Load(BitboardTables.peers[cell])),
+                cellBoard);
+    state.solved = Ops::Or(state.solved, cellBoard);
+    return true;
+  }
+
+  // Naked and hidden singles until nothing changes.
+  // Returns false on a contradiction
+  [[nodiscard]] static bool Propagate(State &state) noexcept {
+    const auto all{Ops::Load(BitboardTables.all)};
+    while (true) {
+      Board once{};
+      Board twice{};
+      Board thrice{};
+      Ops::Accumulate(state.digits, once, twice, thrice);
+      // a cell without candidates
+      if (!Ops::IsZero(Ops::AndNot(all, once))) {
+        return false;
+      }
+
+      auto singles{Ops::AndNot(Ops::AndNot(once, twice), state.solved)};
+      if (!Ops::IsZero(singles)) {
+        do {
+          const auto cell{Ops::LowestCell(singles)};
+          const auto cellBoard{Ops::Load(BitboardTables.cells[cell])};
+          singles = Ops::AndNot(singles, cellBoard);
+          std::size_t digit{};
+          while (digit < Size &&
+                 Ops::IsZero(Ops::And(state.digits[digit], cellBoard))) {
+            digit++;
+          }
+          // an earlier single of this batch took the last candidate
+          if (digit == Size) {
+            return false;
+          }
+          static_cast<void>(Place(state, cell, digit));
+        } while (!Ops::IsZero(singles));
+        continue;
+      }
+
+      bool placed{false};
+      for (std::size_t digit{}; digit < Size; digit++) {
+        if (Ops::IsZero(Ops::AndNot(state.digits[digit], state.solved))) {
+          continue;
+        }
+        for (const auto &unit : BitboardTables.units) {
+          const auto inUnit{Ops::And(state.digits[digit], Ops::Load(unit))};
+          const auto count{Ops::Popcount(inUnit)};
+          if (count == 0) {
+            return false;
+          }
+          if (count == 1 &&
+              !Ops::IsZero(Ops::AndNot(inUnit, state.solved))) {
+            static_cast<void>(
+                Place(state, Ops::LowestCell(inUnit), digit));
+            placed = true;
+          }
+        }
+      }
+      if (!placed) {
+        return true;
+      }
+    }
+  }
+
+  // Returns true once solutionLimit solutions are found
+  [[nodiscard]] bool Search(std::size_t depth) noexcept {
+    const auto &state{states[depth]};
+    const auto unsolved{
+        Ops::AndNot(Ops::Load(BitboardTables.all), state.solved)};
+    if (Ops::IsZero(unsolved)) {
+      if (!solutionCount++) {
+        WriteSolution(state);
+      }
+      return solutionCount >= solutionLimit;
+    }
+    // cancelled or out of budget, unwinds like a reached limit
+    if (++pendingNodes == SearchBudget::CheckInterval) {
+      pendingNodes = 0;
+      if (pBudget->Spend(SearchBudget::CheckInterval)) {
+        return true;
+      }
+    }
+
+    // branch on a cell with 2 candidates if there is one
+    Board once{};
+    Board twice{};
+    Board thrice{};
+    Ops::Accumulate(state.digits, once, twice, thrice);
+    const auto bivalue{Ops::And(Ops::AndNot(twice, thrice), unsolved)};
+    const auto cell{Ops::LowestCell(Ops::IsZero(bivalue) ? unsolved : bivalue)};
+    const auto cellBoard{Ops::Load(BitboardTables.cells[cell])};
+
+    auto &next{states[depth + 1]};
+    for (std::size_t digit{}; digit < Size; digit++) {
+      if (Ops::IsZero(Ops::And(state.digits[digit], cellBoard))) {
+        continue;
+      }
+      next = state;
+      if (Place(next, cell, digit) && Propagate(next) && Search(depth + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void WriteSolution(const State &state) noexcept {
+    for (std::size_t digit{}; digit < Size; digit++) {
+      auto board{state.digits[digit]};
+      while (!Ops::IsZero(board)) {
+        const auto cell{Ops::LowestCell(board)};
+        board = Ops::AndNot(board, Ops::Load(BitboardTables.cells[cell]));
+        solution[cell] = static_cast<std::uint8_t>(digit + 1);
+      }
+    }
+  }
+
+  // every branch solves at least 1 cell. Left uninitialized, Run sets
+  // states[0] and every branch writes the state it uses
+  State states[Cells + 1];
+  std::uint8_t *solution{};
+  std::size_t solutionLimit{};
+  std::size_t solutionCount{};
+  SearchBudget *pBudget{};
+  // nodes not spent from the budget yet
+  std::size_t pendingNodes{};
+};
+
+} // namespace bitboard
@@ -0,0 +1,309 @@
+#pragma once
+#include "sudokuGrid.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Bitmask backtracking over a grid with a compile time size.
+// Every row, column and square keeps a mask of the values it holds, bit v is
+// set when value v is placed. The search is iterative: the empty cells and the
+// branches left per depth are kept in fixed size arrays, so big grids
+// neither recurse nor allocate.
+// A branch is either the values of the cell with the fewest candidates or the
+// places of the value with the fewest places in a row, column or square,
+// whichever has fewer. Hidden singles so cost a single branch.
+template <std::size_t Box> class BitmaskSearch {
+public:
+  using GridType = Grid<Box>;
+  using Tables = GridTables<Box>;
+  // bit 0 is unused, values go up to Size
+  using Mask = std::uint64_t;
+  static_assert(GridType::Size < 64, "values have to fit a mask");
+  // search nodes between two polls of shouldStop
+  static constexpr std::size_t StopCheckInterval{1024};
+
+  // Generates the masks of the grid values and collects the empty cells.
+  // Returns false if a value appears twice in a row, column or square
+  [[nodiscard]] constexpr bool GenerateBitMasks(const GridType &grid) noexcept {
+    rows.fill(0);
+    columns.fill(0);
+    squares.fill(0);
+    emptyCount = 0;
+    for (std::size_t idx{}; idx < GridType::Cells; idx++) {
+      const auto v{grid.values[idx]};
+      if (!v) {
+        positions[idx] = static_cast<Index>(emptyCount);
+        empties[emptyCount++] = static_cast<Index>(idx);
+        continue;
+      }
+      const Mask bit{Mask{1} << v};
+      auto &row{rows[idx / GridType::Size]};
+      auto &column{columns[idx % GridType::Size]};
+      auto &square{squares[Tables::squares[idx]]};
+      if ((row | column | square) & bit) {
+        return false;
+      }
+      row |= bit;
+      column |= bit;
+      square |= bit;
+    }
+    return true;
+  }
+
+  // Returns the amount of solutions up to limit. When the limit is reached
+  // the grid holds the last found solution, otherwise it is left unchanged
+  [[nodiscard]] constexpr std::size_t
+  CountSolutions(GridType &grid, std::size_t limit) noexcept {
+    return CountSolutions(grid, limit, []() { return false; });
+  }
+
+  // Same as above, shouldStop is polled every StopCheckInterval nodes.
+  // A stopped search returns the solutions found so far, the grid is then
+  // partly filled in
+  template <typename ShouldStop>
+  [[nodiscard]] constexpr std::size_t
+  CountSolutions(GridType &grid, std::size_t limit,
+                 ShouldStop &&shouldStop) noexcept {
+    solutionLimit = limit;
+    solutionCount = 0;
+    nodes = 0;
+    if (limit && GenerateBitMasks(grid)) {
+      Solve(grid, shouldStop);
+    }
+    return solutionCount;
+  }
+
+  // Returns the search nodes of the last CountSolutions
+  [[nodiscard]] constexpr std::size_t Nodes() const noexcept { return nodes; }
+
+  // Replaces the grids by their children, branching like the search, until
+  // there are at least minGrids. The children keep the order of the search,
+  // solved grids are kept and dead ends dropped. Returns the children made
+  static std::size_t Split(std::vector<GridType> &grids,
+                           std::size_t minGrids) {
+    BitmaskSearch search{};
+    std::size_t made{};
+    std::vector<GridType> children{};
+    bool branched{true};
+    while (branched && grids.size() < minGrids) {
+      branched = false;
+      children.clear();
+      for (const auto &grid : grids) {
+        if (!search.GenerateBitMasks(grid)) {
+          continue;
+        }
+        if (!search.emptyCount) {
+          children.emplace_back(grid);
+          continue;
+        }
+        auto branch{search.SelectBranch(grid, 0)};
+        while (branch.options) {
+          const auto [idx, v]{PlacementOf(branch)};
+          branch.options &= branch.options - 1;
+          children.emplace_back(grid).values[idx] = v;
+          made++;
+        }
+        branched = true;
+      }
+      grids.swap(children);
+    }
+    return made;
+  }
+
+private:
+  using Index = typename Tables::Index;
+
+  // The options of a depth. Without a value the options are the values of
+  // the cell, with a value they are the places (bit i is units[unit][i]) of
+  // the value in the unit
+  struct Branch {
+    Mask options{};
+    Index cell{};
+    Index unit{};
+    std::uint8_t value{};
+  };
+
+  // every value bit, 1 to Size
+  static constexpr Mask AllValues{((Mask{1} << GridType::Size) - 1) << 1};
+  // Tie break order of the cells. Scattered instead of row by row, filling
+  // big grids line by line backtracks a lot
+  static constexpr std::array<Index, GridType::Cells> TieRank{[]() {
+    // prime, so every cell gets its own rank
+    constexpr std::size_t Stride{7919};
+    std::array<Index, GridType::Cells> rank{};
+    for (std::size_t idx{}; idx < GridType::Cells; idx++) {
+      rank[idx] = static_cast<Index>((idx * Stride) % GridType::Cells);
+    }
+    return rank;
+  }()};
+
+  // Depth first search, stops once solutionLimit solutions are found
+  template <typename ShouldStop>
+  constexpr void Solve(GridType &grid, ShouldStop &shouldStop) noexcept {
+    if (!emptyCount) {
+      solutionCount++;
+      return;
+    }
+
+    std::size_t depth{};
+    branches[0] = SelectBranch(grid, 0);
+    while (true) {
+      auto &branch{branches[depth]};
+      // undo the previous try on this depth
+      if (const auto idx{empties[depth]}; grid.values[idx]) {
+        Toggle(idx, grid.values[idx]);
+        grid.values[idx] = 0;
+      }
+      if (!branch.options) {
+        if (!depth) {
+          return;
+        }
+        depth--;
+        continue;
+      }
+
+      const auto [idx, v]{PlacementOf(branch)};
+      branch.options &= branch.options - 1;
+      // the cells before depth are filled in
+      MoveEmpty(idx, depth);
+      grid.values[idx] = v;
+      Toggle(idx, v);
+      if (depth + 1 == emptyCount) {
+        if (++solutionCount >= solutionLimit) {
+          return;
+        }
+        continue;
+      }
+      if (!(++nodes % StopCheckInterval) && shouldStop()) {
+        return;
+      }
+      depth++;
+      branches[depth] = SelectBranch(grid, depth);
+    }
+  }
+
+  // Returns the branch of the grid, the cells in empties from depth on are
+  // unfilled: the empty cell with the fewest candidates, the lowest TieRank
+  // wins a tie, unless a value of a unit has fewer places. No options is a
+  // dead end. The choice only depends on the grid, so a split search visits
+  // solutions in the same order as a single search
+  constexpr Branch SelectBranch(const GridType &grid,
+                                std::size_t depth) const noexcept {
+    Branch best{};
+    int bestCount{static_cast<int>(GridType::Size) + 1};
+    for (std::size_t i{depth}; i < emptyCount; i++) {
+      const auto idx{empties[i]};
+      const auto free{FreeValues(idx)};
+      const auto count{std::popcount(free)};
+      if (count < bestCount ||
+          (count == bestCount && TieRank[idx] < TieRank[best.cell])) {
+        best = {free, idx};
+        bestCount = count;
+        // cells without branches can go in any order
+        if (count < 2) {
+          return best;
+        }
+      }
+    }
+
+    // counts the places of every value per unit up to 3, bit sliced
+    bool pairFound{};
+    for (std::size_t unit{}; unit < Tables::units.size(); unit++) {
+      Mask once{};
+      Mask twice{};
+      Mask thrice{};
+      Mask placed{};
+      for (const auto idx : Tables::units[unit]) {
+        if (grid.values[idx]) {
+          placed |= Mask{1} << grid.values[idx];
+          continue;
+        }
+        const auto free{FreeValues(idx)};
+        thrice |= twice & free;
+        twice |= once & free;
+        once |= free;
+      }
+      const auto missing{AllValues & ~placed};
+      if (missing & ~once) {
+        return {};
+      }
+      if (const auto singles{missing & once & ~twice}) {
+        return PlacesOf(grid, unit, std::countr_zero(singles));
+      }
+      if (const auto pairs{missing & twice & ~thrice};
+          pairs && !pairFound && bestCount > 2) {
+        best = PlacesOf(grid, unit, std::countr_zero(pairs));
+        pairFound = true;
+      }
+    }
+    return best;
+  }
+
+  // Returns the branch over the places of value v in the unit
+  constexpr Branch PlacesOf(const GridType &grid, std::size_t unit,
+                            int v) const noexcept {
+    Branch branch{{}, {}, static_cast<Index>(unit),
+                  static_cast<std::uint8_t>(v)};
+    for (std::size_t i{}; i < GridType::Size; i++) {
+      const auto idx{Tables::units[unit][i]};
+      if (!grid.values[idx] && (FreeValues(idx) >> v & 1)) {
+        branch.options |= Mask{1} << i;
+      }
+    }
+    return branch;
+  }
+
+  // Returns the cell and value of the lowest option of the branch
+  [[nodiscard]] static constexpr std::pair<Index, std::uint8_t>
+  PlacementOf(const Branch &branch) noexcept {
+    const auto option{std::countr_zero(branch.options)};
+    if (!branch.value) {
+      return {branch.cell, static_cast<std::uint8_t>(option)};
+    }
+    return {Tables::units[branch.unit][option], branch.value};
+  }
+
+  // Returns the values the empty cell can still take
+  [[nodiscard]] constexpr Mask FreeValues(std::size_t idx) const noexcept {
+    return AllValues &
+           ~(rows[idx / GridType::Size] | columns[idx % GridType::Size] |
+             squares[Tables::squares[idx]]);
+  }
+
+  // Swaps the empty cell to the position in empties
+  constexpr void MoveEmpty(std::size_t idx, std::size_t position) noexcept {
+    const auto other{empties[position]};
+    const auto from{positions[idx]};
+    empties[position] = static_cast<Index>(idx);
+    empties[from] = other;
+    positions[idx] = static_cast<Index>(position);
+    positions[other] = from;
+  }
+
+  // Sets or clears value v of the cell in its row, column and square
+  constexpr void Toggle(std::size_t idx, std::size_t v) noexcept {
+    const Mask bit{Mask{1} << v};
+    rows[idx / GridType::Size] ^= bit;
+    columns[idx % GridType::Size] ^= bit;
+    squares[Tables::squares[idx]] ^= bit;
+  }
+
+  // bitmasks for row, column, box
+  std::array<Mask, GridType::Size> rows{};
+  std::array<Mask, GridType::Size> columns{};
+  std::array<Mask, GridType::Size> squares{};
+  // empty cells, the ones before the current depth are filled in
+  std::array<Index, GridType::Cells> empties{};
+  // position of every empty cell in empties
+  std::array<Index, GridType::Cells> positions{};
+  std::size_t emptyCount{};
+  // options left to try per depth
+  std::array<Branch, GridType::Cells> branches{};
+  std::size_t solutionLimit{1};
+  std::size_t solutionCount{};
+  std::size_t nodes{};
+};
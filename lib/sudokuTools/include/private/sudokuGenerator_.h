@@ -1,30 +1,102 @@
 #pragma once
+#include "sudokuDifficulty.h"
 #include "sudokuGenerator.h"
+#include "sudokuRandom.h"
 #include "sudokuSolver.h"
 
-#include <functional>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
+#include <vector>
 
 class Generator;
 
+// All state of a generation lives in the instance, generators on different
+// threads don't share anything
 class SudokuGenerator_ {
 public:
+  using Engine = Random;
+  // Turns the full grid of the generator into another full grid
+  using GenerateFunction = void (*)(Generator &, Engine &);
+
   SudokuGenerator_();
-  SudokuGenerator_(std::function<void(Generator &)> generateFunction_);
+  SudokuGenerator_(GenerateFunction generateFunction_);
   ~SudokuGenerator_() = default;
   SudokuGenerator_(const SudokuGenerator_ &) = delete;
   SudokuGenerator_(SudokuGenerator_ &&) = delete;
   SudokuGenerator_ &operator=(const SudokuGenerator_ &) = delete;
   SudokuGenerator_ &operator=(SudokuGenerator_ &&) = delete;
 
-  [[nodiscard]] bool Generate(Generator &generator);
+  [[nodiscard]] GenerateResult Generate(Generator &generator);
+  [[nodiscard]] bool GenerateGrid(Generator &generator);
   [[nodiscard]] unsigned int TotalTries() const;
-  void SetGenerateFunction(std::function<void(Generator &)> generateFunction);
+  [[nodiscard]] std::size_t SolverCalls() const;
+  void SetGenerateFunction(GenerateFunction generateFunction);
   void Reset();
 
 private:
-  std::function<void(Generator &)> generateFunction;
+  // Removes clues in the dig order of the generator, a removal is kept when
+  // the sudoku still has a single solution and is not rated above the target
+  // difficulty. Stops at the clue target of the generator, unless it digs a
+  // minimal sudoku.
+  // Returns why a solver search stopped early, if it did
+  [[nodiscard]] SearchStop PokeHoles(Generator &generator, Solver &solver);
+  // Removes the clues on the cells together, returns true when they stay
+  // removed: the sudoku keeps a single solution and, with checkDifficulty, is
+  // not rated above the target. A search that stopped early sets searchStop
+  [[nodiscard]] bool TryRemove(const Generator &generator, Solver &solver,
+                               std::span<const std::size_t> cells,
+                               bool checkDifficulty);
+  // Returns true if the value of the hole follows from the clues left, as
+  // the only candidate of the hole or the only place in a row, column or
+  // square. A sudoku with a single solution keeps it without the clue
+  [[nodiscard]] bool IsForced(const Generator &generator, const Solver &solver,
+                              std::size_t idx,
+                              unsigned int value) const noexcept;
+  // Adds or removes the value from the masks of the row, column and square
+  void ToggleMasks(const Generator &generator, std::size_t idx,
+                   unsigned int value) noexcept;
+  // Candidates of the cell if it were a hole, the value of the cell included
+  [[nodiscard]] std::uint64_t
+  CandidatesOf(const Generator &generator, std::size_t idx) const noexcept;
+  // Seeds the engine when the seed of the generator changed
+  void SeedEngine(const Generator &generator) noexcept;
+  // Returns the solver poking holes, made for the size of the generator
+  [[nodiscard]] Solver &DigSolver(const Generator &generator);
+  // Gives the solver the stop token and the budget left of the generation
+  void StartSearch(const Generator &generator, Solver &solver) const noexcept;
+  // Takes the nodes of the last search from the budget left.
+  // Returns false when the search was stopped or the budget is spent
+  [[nodiscard]] bool EndSearch(const Generator &generator) noexcept;
+
+  GenerateFunction generateFunction;
+  // every random choice of a generation comes from here
+  Engine engine;
+  // seed of the generator the engine was last seeded with
+  std::optional<std::uint64_t> seededWith{};
   unsigned int totalTries{};
+  // cells in the order holes are poked
+  std::vector<std::size_t> digOrder{};
+  // values present per row, column and square, bit n - 1 for value n
+  std::vector<std::uint64_t> rowMasks{};
+  std::vector<std::uint64_t> columnMasks{};
+  std::vector<std::uint64_t> squareMasks{};
+  // clues that can't go on their own, a removal only adds solutions
+  std::vector<bool> neededClues{};
+  // solutions counted by the last generation
+  std::size_t solverCalls{};
+  // rating of the sudoku while holes are poked
+  sudokuDifficulty::DifficultyScore difficultyScore{};
+  // counts the solutions while holes are poked, kept while the size and the
+  // solver type stay the same
+  std::optional<Solver> digSolver{};
+  // values of the generator at the start of the generation
+  std::vector<SudokuValue> originalValues{};
+  // search nodes spent by the running generation
+  std::size_t spentNodes{};
+  SearchStop searchStop{SearchStop::None};
 
 protected:
   std::unique_ptr<SudokuSolver> pSudokuSolver;
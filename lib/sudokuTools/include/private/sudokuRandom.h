@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+// xoshiro256** pseudo random generator, seeded through splitmix64.
+// 32 bytes of state and a few shifts per number. Bounded and Shuffle don't
+// depend on the standard library distributions, the same seed gives the same
+// numbers on every platform.
+class Random final {
+public:
+  using result_type = std::uint64_t;
+
+  explicit Random(std::uint64_t seed = 0) noexcept { Seed(seed); }
+
+  void Seed(std::uint64_t seed) noexcept {
+    for (auto &s : state) {
+      seed += 0x9e3779b97f4a7c15;
+      auto z{seed};
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      s = z ^ (z >> 31);
+    }
+  }
+
+  [[nodiscard]] std::uint64_t Next() noexcept {
+    const auto result{Rotl(state[1] * 5, 7) * 9};
+    const auto t{state[1] << 17};
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = Rotl(state[3], 45);
+    return result;
+  }
+
+  // Returns a number in [0, bound) without modulo bias (Lemire), bound > 0
+  [[nodiscard]] std::uint64_t Bounded(std::uint64_t bound) noexcept {
+    auto m{static_cast<unsigned __int128>(Next()) * bound};
+    auto low{static_cast<std::uint64_t>(m)};
+    if (low < bound) {
+      const auto threshold{-bound % bound};
+      while (low < threshold) {
+        m = static_cast<unsigned __int128>(Next()) * bound;
+        low = static_cast<std::uint64_t>(m);
+      }
+    }
+    return static_cast<std::uint64_t>(m >> 64);
+  }
+
+  // Fisher-Yates shuffle of the range
+  template <std::random_access_iterator It>
+  void Shuffle(It first, It last) noexcept {
+    for (auto n{static_cast<std::uint64_t>(last - first)}; n > 1; n--) {
+      using std::swap;
+      swap(first[n - 1], first[Bounded(n)]);
+    }
+  }
+
+  // UniformRandomBitGenerator, for the standard algorithms
+  [[nodiscard]] static constexpr result_type min() noexcept { return 0; }
+  [[nodiscard]] static constexpr result_type max() noexcept {
+    return std::numeric_limits<result_type>::max();
+  }
+  [[nodiscard]] result_type operator()() noexcept { return Next(); }
+
+private:
+  [[nodiscard]] static constexpr std::uint64_t Rotl(std::uint64_t x,
+                                                    int k) noexcept {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  std::array<std::uint64_t, 4> state{};
+};
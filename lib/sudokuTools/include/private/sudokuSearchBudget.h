@@ -0,0 +1,29 @@
+#pragma once
+#include "sudokuHelpers.h"
+#include <atomic>
+#include <cstddef>
+#include <stop_token>
+
+// Stop token and node budget of a single search call.
+// Backends count their own nodes and spend them every CheckInterval nodes,
+// only then the token and the budget are checked. Spend is safe to call from
+// several threads. Nothing is defined in the header: the bitboard kernels are
+// compiled with instruction set flags and may not emit their own copy.
+class SearchBudget final {
+public:
+  static constexpr std::size_t CheckInterval{1024};
+
+  // Starts a new search, nodeBudget 0 is unlimited
+  void Start(std::stop_token stopToken, std::size_t nodeBudget) noexcept;
+  // Adds the nodes, returns true when the search has to stop
+  [[nodiscard]] bool Spend(std::size_t nodes) noexcept;
+  // Adds the nodes without a check, for the nodes left when a search ends
+  void Count(std::size_t nodes) noexcept;
+  [[nodiscard]] SearchStats Stats() const noexcept;
+
+private:
+  std::stop_token stopToken{};
+  std::size_t nodeBudget{};
+  std::atomic<std::size_t> spent{};
+  std::atomic<SearchStop> stop{SearchStop::None};
+};
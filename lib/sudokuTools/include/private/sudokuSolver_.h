@@ -1,5 +1,13 @@
 #pragma once
+#include "sudokuBitboard.h"
+#include "sudokuGrid.h"
 #include "sudokuHelpers.h"
+#include "sudokuSearchBudget.h"
+#include "sudokuThreadPool.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
 class Solver;
@@ -7,24 +15,62 @@ class Solver;
 class SudokuSolver_ {
 public:
   SolverTypes solverType{SolverTypes::None};
+  // Stop token and node budget of the running call, started by SudokuSolver
+  SearchBudget budget{};
 
   SudokuSolver_() = default;
   virtual ~SudokuSolver_() = default;
 
   // Returns true if sudoku can be solved, solves sudoku in values
   virtual bool Solve(Solver &solver) noexcept = 0;
+  // Returns the amount of solutions, stops searching once limit is reached
+  [[nodiscard]] virtual std::size_t
+  CountSolutions(const Solver &solver, std::size_t limit) noexcept = 0;
   // Returns true if the sudoku can be solved
   [[nodiscard]] virtual bool CanBeSolved(const Solver &solver) noexcept;
   // Returns true if the values can be placed on a location in values
+  // Default scans the row, column and square of the location
   [[nodiscard]] virtual bool CanBePlaced(const Solver &solver,
                                          ValueLocation location,
-                                         SudokuValue value) const noexcept = 0;
-  // Validates the correctness of the sudoku values
-  [[nodiscard]] virtual bool ValidateSudoku(const Solver &solver) noexcept = 0;
+                                         SudokuValue value) const noexcept;
+  // Validates the correctness of the sudoku values in a single pass over the
+  // cells. Stops at the first conflict, unless pConflicts is given, then all
+  // conflicting pairs are added to it
+  [[nodiscard]] bool
+  ValidateSudoku(const Solver &solver,
+                 std::vector<ValueConflict> *pConflicts = nullptr) noexcept;
   // Prepares the solver for a continuous game
   virtual void PrepareSudoku(const Solver &solver) noexcept = 0;
+  // Forgets the state of previous solves, keeps allocated buffers
+  virtual void Reset() noexcept {}
+
+protected:
+  // Counts a search node, returns true when the search has to stop.
+  // The budget is only checked every SearchBudget::CheckInterval nodes
+  [[nodiscard]] bool SpendNode() noexcept {
+    if (++pendingNodes < SearchBudget::CheckInterval) {
+      return false;
+    }
+    pendingNodes = 0;
+    return budget.Spend(SearchBudget::CheckInterval);
+  }
+  // Counts the nodes SpendNode did not pass on yet, call when a search ends
+  void CountPendingNodes() noexcept {
+    budget.Count(pendingNodes);
+    pendingNodes = 0;
+  }
+
+private:
+  std::size_t pendingNodes{};
+  static constexpr std::size_t NoCell{static_cast<std::size_t>(-1)};
+  // first cell holding a value per (row|column|square, value), reused
+  std::vector<std::size_t> firstSeen{};
 };
 
+// Backtracks cell by cell with a bitmask per row, column and square.
+// Runs on the Grid instantiation matching the section size of the solver.
+// With more than 1 thread the top of the search tree is split into subtrees
+// that run on a work stealing pool.
 class SudokuSolver_bitmasks final : public SudokuSolver_ {
 public:
   SolverTypes solverType{SolverTypes::Bitstring};
@@ -33,28 +79,162 @@ public:
   ~SudokuSolver_bitmasks() = default;
 
   [[nodiscard]] bool Solve(Solver &solver) noexcept override;
-  [[nodiscard]] bool CanBePlaced(const Solver &solver, ValueLocation location,
-                                 SudokuValue value) const noexcept override;
-  [[nodiscard]] bool ValidateSudoku(const Solver &solver) noexcept override;
-  [[nodiscard]] bool CanBeSolved(const Solver &solver) noexcept override;
+  [[nodiscard]] std::size_t CountSolutions(const Solver &solver,
+                                           std::size_t limit) noexcept override;
   void PrepareSudoku(const Solver &solver) noexcept override;
 
 private:
-  [[nodiscard]] bool Solve(Solver &solver, ValueLocation location);
-  // Generates the initial bitmask value according to given values
-  void GenerateBitMasks(const Solver &solver);
-  // Clears all bit masks
-  void ClearBitMasks();
-  // Helper to set all 3 bitmasks for location/value
-  void SetBitMasks(const Solver &solver, ValueLocation location,
-                   SudokuValue value) noexcept;
-  // Helper to reset all 3 bitmasks for location/value
-  void ResetBitMasks(const Solver &solver, ValueLocation location,
-                     SudokuValue value) noexcept;
-  // Returns true if bitmasks are generates
-  [[nodiscard]] bool GeneratedBitMasks(const Solver &solver) const noexcept;
-  // bitmasks for row, column, box
-  std::vector<unsigned int> bitMasksRows{};
-  std::vector<unsigned int> bitMasksColumns{};
-  std::vector<unsigned int> bitMasksSquares{};
-};
\ No newline at end of file
+  // Returns the amount of solutions up to limit, writes the last found
+  // solution to pSolution when the limit is reached
+  [[nodiscard]] std::size_t Run(const Solver &solver, std::size_t limit,
+                                std::vector<SudokuValue> *pSolution) noexcept;
+  // Searches the subtrees on the pool, same result as a single threaded
+  // search. With a limit of 1 the grid holds the solution of the first
+  // subtree (in search order) that has one
+  template <std::size_t Box>
+  [[nodiscard]] std::size_t RunParallel(Grid<Box> &grid, std::size_t limit);
+
+  // subtrees per thread, more subtrees balance better
+  static constexpr std::size_t TasksPerThread{16};
+  std::unique_ptr<ThreadPool> pPool{};
+};
+
+// Dancing links (Algorithm X) over the exact cover matrix of the sudoku.
+// The matrix is built once per sudoku size, the node arena is reused between
+// solves.
+class SudokuSolver_dancingLinks final : public SudokuSolver_ {
+public:
+  SolverTypes solverType{SolverTypes::DancingLinks};
+
+  SudokuSolver_dancingLinks() = default;
+  ~SudokuSolver_dancingLinks() = default;
+
+  [[nodiscard]] bool Solve(Solver &solver) noexcept override;
+  [[nodiscard]] std::size_t CountSolutions(const Solver &solver,
+                                           std::size_t limit) noexcept override;
+  void PrepareSudoku(const Solver &solver) noexcept override;
+  void Reset() noexcept override;
+
+private:
+  // A node of the toroidal doubly linked list, links are arena indexes
+  struct Node {
+    std::size_t left{};
+    std::size_t right{};
+    std::size_t up{};
+    std::size_t down{};
+    std::size_t column{};
+    std::size_t row{};
+  };
+
+  // Builds the exact cover matrix for the given sudoku size
+  void BuildMatrix(const Solver &solver);
+  // Selects a matrix row as part of the solution, covers all its columns
+  void SelectRow(std::size_t row) noexcept;
+  // Undoes SelectRow
+  void DeselectRow(std::size_t row) noexcept;
+  void Cover(std::size_t column) noexcept;
+  void Uncover(std::size_t column) noexcept;
+  // Covers the givens, searches and restores the matrix.
+  // Returns the amount of solutions found, up to solutionLimit
+  [[nodiscard]] std::size_t Run(const Solver &solver, std::size_t limit);
+  // Algorithm X, returns true once solutionLimit solutions are found
+  [[nodiscard]] bool Search() noexcept;
+  // Returns the matrix row of a value on a location
+  [[nodiscard]] std::size_t MatrixRow(std::size_t idx,
+                                      unsigned int value) const noexcept;
+
+  // node 0 is the root, followed by the column headers and the row nodes
+  std::vector<Node> nodes{};
+  std::vector<std::size_t> columnSizes{};
+  // first node of each matrix row
+  std::vector<std::size_t> rowNodes{};
+  // selected matrix rows, givens first
+  std::vector<std::size_t> selectedRows{};
+  // selected matrix rows of the first found solution
+  std::vector<std::size_t> solutionRows{};
+  std::size_t solutionLimit{1};
+  std::size_t solutionCount{};
+  std::size_t matrixSize{};
+  std::size_t matrixSectionSize{};
+};
+
+// Keeps candidate masks per cell, propagates naked and hidden singles after
+// every assignment and branches on the cell with the fewest candidates (MRV).
+class SudokuSolver_propagation final : public SudokuSolver_ {
+public:
+  SolverTypes solverType{SolverTypes::ConstraintPropagation};
+
+  SudokuSolver_propagation() = default;
+  ~SudokuSolver_propagation() = default;
+
+  [[nodiscard]] bool Solve(Solver &solver) noexcept override;
+  [[nodiscard]] std::size_t CountSolutions(const Solver &solver,
+                                           std::size_t limit) noexcept override;
+  void PrepareSudoku(const Solver &solver) noexcept override;
+  void Reset() noexcept override;
+
+private:
+  // Candidates and placed values of every cell, 0 is an empty cell
+  struct State {
+    std::vector<std::uint64_t> candidates{};
+    std::vector<unsigned int> values{};
+    std::size_t filled{};
+  };
+
+  // Builds the unit and peer tables for the given sudoku size
+  void BuildTables(const Solver &solver);
+  // Places the value and propagates naked and hidden singles.
+  // Returns false on a contradiction
+  [[nodiscard]] bool Assign(State &state, std::size_t idx,
+                            unsigned int value) noexcept;
+  // Propagates the givens and searches.
+  // Returns the amount of solutions found, up to solutionLimit
+  [[nodiscard]] std::size_t Run(const Solver &solver, std::size_t limit);
+  // Depth first search on the cell with the fewest candidates.
+  // Returns true once solutionLimit solutions are found
+  [[nodiscard]] bool Search(std::size_t depth) noexcept;
+
+  std::size_t tableSize{};
+  std::size_t tableSectionSize{};
+  // every row, column and square as a list of cell indexes
+  std::vector<std::size_t> units{};
+  // the row, column and square of every cell
+  std::vector<std::size_t> cellUnits{};
+  // every cell sharing a unit with a cell, peersPerCell per cell
+  std::vector<std::size_t> peers{};
+  std::size_t peersPerCell{};
+  // one state per search depth, reused between solves
+  std::vector<State> states{};
+  // values of the first found solution
+  std::vector<unsigned int> solution{};
+  std::size_t solutionLimit{1};
+  std::size_t solutionCount{};
+  // pending (cell, value) assignments while propagating
+  std::vector<std::pair<std::size_t, unsigned int>> pending{};
+  std::vector<bool> dirtyUnits{};
+};
+
+// 9x9 only, one 81 bit board per value with the cells it can still go on.
+// Propagation runs as vector and/andnot/popcount, the kernel for the best
+// instruction set of the cpu is selected at construction.
+class SudokuSolver_bitboard final : public SudokuSolver_ {
+public:
+  SolverTypes solverType{SolverTypes::Bitboard};
+
+  SudokuSolver_bitboard();
+  ~SudokuSolver_bitboard() = default;
+
+  [[nodiscard]] bool Solve(Solver &solver) noexcept override;
+  [[nodiscard]] std::size_t CountSolutions(const Solver &solver,
+                                           std::size_t limit) noexcept override;
+  void PrepareSudoku(const Solver &solver) noexcept override;
+
+private:
+  // Returns the amount of solutions up to limit, the first one in solution
+  [[nodiscard]] std::size_t Run(const Solver &solver,
+                                std::size_t limit) noexcept;
+
+  bitboard::KernelFunction kernel;
+  std::array<std::uint8_t, bitboard::Cells> givens{};
+  std::array<std::uint8_t, bitboard::Cells> solution{};
+};
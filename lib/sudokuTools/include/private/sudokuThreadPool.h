@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Work stealing thread pool with a fixed amount of workers.
+// Every worker owns a task deque: it runs its newest task first and steals the
+// oldest task of another worker once its own deque is empty. Tasks are meant
+// to be coarse (a subtree of a search), a deque is only locked per task.
+class ThreadPool final {
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(std::size_t threadCount);
+  // Stops the workers, tasks that did not start yet are dropped
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+
+  // Returns the amount of worker threads
+  [[nodiscard]] std::size_t Size() const noexcept { return workers.size(); }
+  // Queues a task, tasks are spread over the workers round robin
+  void Submit(Task task);
+  // Blocks until every submitted task has run
+  void Wait();
+
+private:
+  struct Worker {
+    std::mutex mutex{};
+    std::deque<Task> tasks{};
+  };
+
+  void WorkerLoop(std::stop_token stopToken, std::size_t index);
+  // Takes the newest task of the worker
+  [[nodiscard]] bool TryPop(std::size_t index, Task &task);
+  // Takes the oldest task of any other worker
+  [[nodiscard]] bool TrySteal(std::size_t index, Task &task);
+
+  std::vector<std::unique_ptr<Worker>> workers{};
+  std::mutex mutex{};
+  // wakes workers when tasks are queued
+  std::condition_variable_any wake{};
+  // wakes Wait when the last task finished
+  std::condition_variable_any done{};
+  // tasks in a deque, only increased while holding mutex
+  std::atomic<std::size_t> queued{};
+  // tasks submitted but not finished
+  std::atomic<std::size_t> pending{};
+  std::size_t nextWorker{};
+  // last member, the threads stop and join before anything else is destroyed
+  std::vector<std::jthread> threads{};
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include "sudokuHelpers.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+// Canonical form of a sudoku under every symmetry that keeps a sudoku valid:
+// permuting the bands, the rows in a band, the stacks, the columns in a
+// stack, transposing and relabeling the digits. Two sudokus are the same up
+// to symmetry when their canonical forms are equal.
+// The canonical form is the smallest (minlex) row major string of the
+// symmetric sudokus, empty cells are 0 and digits are relabeled 1, 2, ... in
+// the order they first appear.
+namespace sudokuCanonical {
+
+// A 128 bit hash of a canonical form
+struct Fingerprint {
+  std::uint64_t high{};
+  std::uint64_t low{};
+
+  [[nodiscard]] bool operator==(const Fingerprint &) const = default;
+};
+
+// Maps the canonical form back to the sudoku it was made from
+struct Transform {
+  // cell of the sudoku shown on each canonical cell
+  std::vector<std::size_t> cellOf{};
+  // value of the sudoku behind each canonical label, 0 for unused labels
+  std::vector<unsigned int> valueOf{};
+};
+
+// Finds canonical forms, the buffers are reused between sudokus.
+// The search picks the rows one by one and keeps only the choices giving the
+// smallest row. Columns the rows so far can't tell apart stay unordered until
+// a row does, new digits are the only choices that branch. Of the choices a
+// symmetry of the rows left maps onto each other only the first is searched.
+// Rows full of new digits still branch on every column order, so (nearly)
+// full 16x16 and bigger sudokus run into the node budget.
+class Canonicalizer {
+public:
+  // nodes (rows picked) a call may search, enough for any 9x9 sudoku
+  static constexpr std::size_t DefaultNodeBudget{std::size_t{1} << 18};
+
+  // Returns the canonical form of the sudoku, valid until the next call.
+  // Gives up and returns an empty span after nodeBudget nodes (0 is
+  // unlimited) or once a stop is requested.
+  // Throws for sizes that are not square or above 64
+  [[nodiscard]] std::span<const std::uint8_t>
+  Canonicalize(std::span<const SudokuValue> values, std::size_t size,
+               std::size_t sectionSize, std::stop_token stopToken = {},
+               std::size_t nodeBudget = DefaultNodeBudget);
+  // Transform of the last canonical form
+  [[nodiscard]] const Transform &LastTransform() const noexcept {
+    return transform;
+  }
+
+private:
+  struct State;
+  struct Search;
+
+  // Orders the columns and stacks so the row is smallest, writes the keys of
+  // the row in canonical order to rowKeys
+  static void SortRow(State &state, const std::uint8_t *row,
+                      std::size_t sectionSize, std::uint8_t *rowKeys);
+  // Picks the next row of the canonical form, depth rows are picked
+  void PickRow(Search &search, const State &state, std::size_t depth);
+  // Orders the new digits of the row, every order is a branch
+  void Individualize(Search &search, State &state, std::size_t depth,
+                     std::size_t row);
+  // Returns true if swapping the columns a[i] and b[i] and the new digits
+  // they hold in the row keeps the sudoku the same
+  [[nodiscard]] static bool IsSymmetry(const Search &search,
+                                       const State &state, std::size_t row,
+                                       const std::uint8_t *a,
+                                       const std::uint8_t *b,
+                                       std::size_t count);
+
+  std::vector<std::uint8_t> grid{};
+  std::vector<std::uint8_t> transposed{};
+  std::vector<std::uint8_t> best{};
+  Transform transform{};
+};
+
+// Returns the fingerprint of a canonical form
+[[nodiscard]] Fingerprint
+FingerprintOf(std::span<const std::uint8_t> canonical) noexcept;
+
+// Set of fingerprints, open addressing with 16 bytes per slot
+class FingerprintSet {
+public:
+  // Returns false if the fingerprint was in the set already
+  bool Insert(Fingerprint fingerprint);
+  [[nodiscard]] bool Contains(Fingerprint fingerprint) const noexcept;
+  [[nodiscard]] std::size_t Size() const noexcept { return count; }
+
+private:
+  // Returns the slot holding the fingerprint or the empty slot it goes to
+  [[nodiscard]] std::size_t SlotOf(Fingerprint fingerprint) const noexcept;
+  void Grow();
+
+  std::vector<Fingerprint> slots{};
+  std::size_t count{};
+};
+
+} // namespace sudokuCanonical
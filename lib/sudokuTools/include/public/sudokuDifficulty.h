@@ -1,12 +1,45 @@
 #pragma once
 #include "sudokuHelpers.h"
+#include <cstddef>
+#include <span>
+#include <vector>
 
 namespace sudokuDifficulty {
 
 enum class Difficulty : unsigned int { easy = 0, normal = 50, hard = 100 };
 
 [[nodiscard]] Difficulty
-CalculateDifficulty(const std::vector<SudokuValue> &sudoku,
+CalculateDifficulty(std::span<const SudokuValue> sudoku,
                     const std::size_t size, const std::size_t sectionSize);
 
+// Difficulty score that follows single values being removed and placed.
+// Keeps the missing values per row, column and square and the count of every
+// value, an update only rescores the conditions of the changed cell
+class DifficultyScore {
+public:
+  // Scores the sudoku from scratch, the buffers are reused
+  void Reset(std::span<const SudokuValue> sudoku, std::size_t size,
+             std::size_t sectionSize);
+  // Updates the score for the value removed from the cell
+  void Remove(std::size_t idx, unsigned int value) noexcept;
+  // Updates the score for the value placed on the empty cell
+  void Place(std::size_t idx, unsigned int value) noexcept;
+  [[nodiscard]] int Score() const noexcept { return score; }
+  [[nodiscard]] Difficulty GetDifficulty() const noexcept;
+
+private:
+  void Update(std::size_t idx, unsigned int value, int missingDelta) noexcept;
+  [[nodiscard]] std::size_t SquareOf(std::size_t idx) const noexcept;
+
+  std::size_t size{};
+  std::size_t sectionSize{};
+  std::size_t missing{};
+  std::vector<std::size_t> rowMissing{};
+  std::vector<std::size_t> columnMissing{};
+  std::vector<std::size_t> squareMissing{};
+  // cells holding each value, index 0 is unused
+  std::vector<std::size_t> valueCount{};
+  int score{};
+};
+
 }; // namespace sudokuDifficulty
\ No newline at end of file
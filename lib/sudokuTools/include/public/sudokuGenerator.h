@@ -1,11 +1,31 @@
 #pragma once
+#include "sudokuDifficulty.h"
 #include "sudokuHelpers.h"
+#include "sudokuStream.h"
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <vector>
 
 class SudokuGenerator_;
 
+// Order in which the clues of a full grid are tried for removal
+enum class DigOrder {
+  // every clue on its own, in a random order
+  Random,
+  // a clue together with its 180 degree rotation
+  RotationalPairs,
+  // a clue together with its mirror over the vertical axis
+  MirrorPairs,
+  // the clue that would have the fewest candidates as a hole first, these are
+  // often forced and need no solver call
+  MostConstrained
+};
+
 struct Generator {
   Generator() = delete;
   Generator(const std::size_t size_, const std::size_t sectionSize_,
@@ -20,6 +40,42 @@ struct Generator {
 
   const GeneratorTypes generatorType;
   std::chrono::seconds maxGenerationTime;
+  // Clues left in the sudoku, holes are only poked while the solution stays
+  // unique. 0 pokes holes until no clue can go (a minimal sudoku)
+  std::size_t targetClues{};
+  // Rating of the sudoku, holes that would rate it above the target are not
+  // poked and sudokus that end below it are dropped. Not used by Transform
+  std::optional<sudokuDifficulty::Difficulty> targetDifficulty{};
+  DigOrder digOrder{DigOrder::Random};
+  // Tries every clue (pair under a symmetric dig order) left after digging,
+  // no clue of the sudoku can go without losing the single solution. Digging
+  // ignores the clue target but keeps holes that would rate the sudoku above
+  // the difficulty, the pass over the clues left ignores the difficulty.
+  // Sudokus above the clue target or off the difficulty are dropped
+  bool minimal{};
+  // Seeds the generator when it differs from the seed of the previous call,
+  // following calls continue the sequence: a run with a seed is reproducible.
+  // Without a seed the generator is seeded from std::random_device
+  std::optional<std::uint64_t> seed{};
+  // Sudokus of the generator size with a single solution, a Transform
+  // generator picks one per call and relabels its digits, permutes its bands,
+  // stacks, rows and columns and may transpose it. Clues and the single
+  // solution are kept
+  std::vector<std::vector<SudokuValue>> transformSeeds{};
+  // Ends the generation when a stop is requested, also ends running searches
+  std::stop_token stopToken{};
+  // Search nodes all solver calls of a generation may visit, 0 is unlimited
+  std::size_t nodeBudget{};
+};
+
+enum class GenerateResult { Generated, TimedOut, Cancelled, BudgetExceeded };
+
+// Sudoku of a generate stream, views the values of the generator
+struct GeneratedSudoku {
+  std::span<const SudokuValue> values{};
+  sudokuDifficulty::Difficulty difficulty{};
+  // solutions counted by the solver to generate the sudoku
+  std::size_t solverCalls{};
 };
 
 class SudokuGenerator {
@@ -31,8 +87,19 @@ public:
   SudokuGenerator &operator=(const SudokuGenerator &) = delete;
   SudokuGenerator &operator=(SudokuGenerator &&) = delete;
 
-  [[nodiscard]] bool Generate(Generator &generator);
+  [[nodiscard]] GenerateResult Generate(Generator &generator);
+  // Turns the values of the generator into the next full grid, no holes are
+  // poked. A None generator can poke the holes later, on another thread.
+  // Returns false when the grid is not valid, the Shuffle grids can't be used
+  [[nodiscard]] bool GenerateGrid(Generator &generator);
+  // Generates a sudoku per increment until a generation fails or a stop is
+  // requested. Every sudoku reuses the values of the generator, the generator
+  // and this SudokuGenerator have to outlive the stream
+  [[nodiscard]] Stream<GeneratedSudoku> GenerateStream(Generator &generator);
   [[nodiscard]] unsigned int TotalTries() const;
+  // Solutions counted by the solver during the last generation, holes that
+  // are forced by the clues left are poked without one
+  [[nodiscard]] std::size_t SolverCalls() const;
   void Reset();
 
 private:
@@ -0,0 +1,123 @@
+#pragma once
+#include "sudokuHelpers.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Sudoku grid with the box (section) size known at compile time.
+// Grid<3> is a 9x9 sudoku, Grid<4> a 16x16 sudoku, Grid<5> a 25x25 sudoku.
+// Values are stored row major, 0 is an empty cell.
+template <std::size_t Box> struct Grid {
+  static_assert(Box >= 2 && Box <= 15, "values have to fit a byte");
+
+  static constexpr std::size_t SectionSize{Box};
+  static constexpr std::size_t Size{Box * Box};
+  static constexpr std::size_t Cells{Size * Size};
+
+  std::array<std::uint8_t, Cells> values{};
+
+  [[nodiscard]] bool operator==(const Grid &) const = default;
+};
+
+// Index tables of a grid, computed at compile time
+template <std::size_t Box> struct GridTables {
+  using Index = std::uint16_t;
+  static constexpr std::size_t Size{Grid<Box>::Size};
+  static constexpr std::size_t Cells{Grid<Box>::Cells};
+  // row + column + square, minus the overlap of the square with both lines
+  static constexpr std::size_t PeerCount{3 * (Size - 1) - 2 * (Box - 1)};
+
+  // square index of every cell
+  static constexpr std::array<std::uint8_t, Cells> squares{[]() {
+    std::array<std::uint8_t, Cells> squares{};
+    for (std::size_t idx{}; idx < Cells; idx++) {
+      squares[idx] = static_cast<std::uint8_t>(Box * ((idx / Size) / Box) +
+                                                (idx % Size) / Box);
+    }
+    return squares;
+  }()};
+
+  // rows, then columns, then squares as cell indexes
+  static constexpr std::array<std::array<Index, Size>, 3 * Size> units{[]() {
+    std::array<std::array<Index, Size>, 3 * Size> units{};
+    std::array<std::size_t, 3 * Size> filled{};
+    for (std::size_t idx{}; idx < Cells; idx++) {
+      const std::size_t unitsOfCell[]{idx / Size, Size + idx % Size,
+                                      2 * Size + squares[idx]};
+      for (auto unit : unitsOfCell) {
+        units[unit][filled[unit]++] = static_cast<Index>(idx);
+      }
+    }
+    return units;
+  }()};
+
+  // every cell sharing a row, column or square with a cell
+  static constexpr std::array<std::array<Index, PeerCount>, Cells> peers{
+      []() {
+        std::array<std::array<Index, PeerCount>, Cells> peers{};
+        for (std::size_t idx{}; idx < Cells; idx++) {
+          std::size_t filled{};
+          for (std::size_t other{}; other < Cells; other++) {
+            if (other != idx &&
+                (other / Size == idx / Size || other % Size == idx % Size ||
+                 squares[other] == squares[idx])) {
+              peers[idx][filled++] = static_cast<Index>(other);
+            }
+          }
+        }
+        return peers;
+      }()};
+};
+
+// Copies the values into the grid, returns false if they don't fit
+template <std::size_t Box>
+[[nodiscard]] constexpr bool ToGrid(const std::vector<SudokuValue> &values,
+                                    Grid<Box> &grid) noexcept {
+  if (values.size() != Grid<Box>::Cells) {
+    return false;
+  }
+  for (std::size_t idx{}; idx < Grid<Box>::Cells; idx++) {
+    const auto v{values[idx].value_or(0)};
+    if (v > Grid<Box>::Size) {
+      return false;
+    }
+    grid.values[idx] = static_cast<std::uint8_t>(v);
+  }
+  return true;
+}
+
+// Copies the grid into the values
+template <std::size_t Box>
+constexpr void FromGrid(const Grid<Box> &grid,
+                        std::vector<SudokuValue> &values) {
+  values.resize(Grid<Box>::Cells);
+  for (std::size_t idx{}; idx < Grid<Box>::Cells; idx++) {
+    values[idx] = grid.values[idx] ? SudokuValue{grid.values[idx]}
+                                   : SudokuValue{};
+  }
+}
+
+// Calls function with std::integral_constant<std::size_t, Box> for the box
+// sizes that have a grid instantiation.
+// Returns false if the section size is not supported
+template <typename Function>
+constexpr bool VisitGrid(std::size_t sectionSize, Function &&function) {
+  switch (sectionSize) {
+  case 2:
+    function(std::integral_constant<std::size_t, 2>{});
+    return true;
+  case 3:
+    function(std::integral_constant<std::size_t, 3>{});
+    return true;
+  case 4:
+    function(std::integral_constant<std::size_t, 4>{});
+    return true;
+  case 5:
+    function(std::integral_constant<std::size_t, 5>{});
+    return true;
+  default:
+    return false;
+  }
+}
@@ -3,11 +3,28 @@
 #include <cstddef>
 #include <optional>
 #include <ranges>
+#include <span>
 #include <string>
 #include <vector>
 
-enum class SolverTypes { None = 0, Bitstring = 1 };
-enum class GeneratorTypes { None = 0, Shuffle = 1, Shift = 2 };
+enum class SolverTypes {
+  None = 0,
+  Bitstring = 1,
+  DancingLinks = 2,
+  ConstraintPropagation = 3,
+  Bitboard = 4
+};
+// Transform relabels and permutes the seed sudokus of the generator, no
+// solver runs. None pokes holes in the full grid the generator holds
+enum class GeneratorTypes { None = 0, Shuffle = 1, Shift = 2, Transform = 3 };
+// Why a search ended before it was done
+enum class SearchStop { None = 0, Cancelled = 1, BudgetExceeded = 2 };
+
+// Effort of the last search call
+struct SearchStats {
+  std::size_t nodes{};
+  SearchStop stop{SearchStop::None};
+};
 
 // X Y location
 using X = std::size_t;
@@ -17,6 +34,19 @@ using ValueLocation = std::pair<X, Y>;
 using SudokuValue = std::optional<unsigned int>;
 // Every sudoku value can be locked
 using LockableValue = std::pair<bool, SudokuValue>;
+// Two sudoku positions holding the same value in a row, column or square
+using ValueConflict = std::pair<std::size_t, std::size_t>;
+
+// Returns the section (square) size of a sudoku size: 3 for 9x9, 4 for
+// 16x16. Returns 0 if the size is not a square number
+[[nodiscard]] static constexpr std::size_t
+SectionSizeOf(const std::size_t size) noexcept {
+  std::size_t sectionSize{};
+  while ((sectionSize + 1) * (sectionSize + 1) <= size) {
+    sectionSize++;
+  }
+  return sectionSize * sectionSize == size ? sectionSize : 0;
+}
 
 // Returns a 1D index given a 2D location
 [[nodiscard]] static inline const std::size_t
@@ -58,23 +88,11 @@ GetIndexOfSquare(const std::size_t size, const std::size_t sectionSize,
     return {};
   }
 
-  // example:
-  // for square 5, result should be 33
-
-  // find first value index of row corresponding to squareIdx (eg the 5th row)
-  // (squareIdx * size) = 45
-  // (half of) the amount of squares to backtrack
-  // (squareIdx % 3) = 2
-  // backtrack from 45 to 33
-  // 45 - (2 * 2) * 3
-  // = 45 - 4 * 3
-  // = 45 - 12
-  // = 33
-  // <first square of "squareIdx" row from top> - (<corresponds to the amount of
-  // square to backtrack to reach the first in the square> * <2:because this is
-  // how it works> * <section size, to actually reach the first value in the
-  // section/square>)
-  return {(squareIdx * size) - (((squareIdx % sectionSize) * 2) * sectionSize)};
+  // example: for square 5 of a 9x9 sudoku, result should be 33
+  // the square starts on row (5 / 3) * 3 = 3 and column (5 % 3) * 3 = 6
+  // 3 * 9 + 6 = 33
+  return {(squareIdx / sectionSize) * sectionSize * size +
+          (squareIdx % sectionSize) * sectionSize};
 }
 
 [[nodiscard]] static const std::vector<std::size_t>
@@ -150,7 +168,7 @@ GetAllIndexesOfRow(const std::size_t size, const std::size_t row) {
 // }
 
 [[nodiscard]] static constexpr std::string
-ParseToString(const std::vector<SudokuValue> &values, char delim = ',',
+ParseToString(std::span<const SudokuValue> values, char delim = ',',
               char emptyChar = 'x') {
   std::string str{};
   for (auto &v : values) {
@@ -165,13 +183,21 @@ ParseToString(const std::vector<SudokuValue> &values, char delim = ',',
 static constexpr void ParseFromString(std::vector<SudokuValue> &values,
                                       const std::string &string,
                                       char delim = ',', char emptyChar = 'x') {
+  // values of sudokus bigger than 9x9 take more than 1 digit
+  std::optional<unsigned int> number{};
   for (const auto c : string) {
     if (c == delim) {
-      continue;
+      if (number.has_value()) {
+        values.emplace_back(*number);
+        number.reset();
+      }
     } else if (c == emptyChar) {
       values.emplace_back(SudokuValue{});
     } else if (std::isdigit(c)) {
-      values.emplace_back(SudokuValue{std::stoi(std::string(1, c))});
+      number = number.value_or(0) * 10 + static_cast<unsigned int>(c - '0');
     }
   }
+  if (number.has_value()) {
+    values.emplace_back(*number);
+  }
 }
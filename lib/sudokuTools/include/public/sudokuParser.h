@@ -1,10 +1,19 @@
 #pragma once
 #include "sudokuDifficulty.h"
 #include "sudokuHelpers.h"
+#include <span>
+#include <string>
 #include <vector>
 
 namespace sudokuParser {
-void ParseToFile(const std::vector<SudokuValue> &values,
+// Appends the line of the sudoku in a sudoku file to the buffer, newline
+// included
+void AppendLine(std::string &buffer, std::span<const SudokuValue> values,
+                sudokuDifficulty::Difficulty difficulty);
+// Returns the line of the sudoku in a sudoku file, newline included
+[[nodiscard]] std::string ParseToLine(std::span<const SudokuValue> values,
+                                      sudokuDifficulty::Difficulty difficulty);
+void ParseToFile(std::span<const SudokuValue> values,
                  sudokuDifficulty::Difficulty, const std::string &file);
 void ParseFromFile(std::vector<SudokuValue> &values, const std::string &file);
 } // namespace sudokuParser
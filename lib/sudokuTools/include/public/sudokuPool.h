@@ -0,0 +1,63 @@
+#pragma once
+#include "sudokuDifficulty.h"
+#include "sudokuHelpers.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Client side and protocol of the puzzle pool daemon (Shelldoku_generator
+// --daemon). A client sends a Request over a local stream socket, the daemon
+// answers with a ResponseHeader followed by one byte per cell, 0 is an empty
+// cell. A connection can carry several requests.
+namespace sudokuPool {
+
+constexpr std::uint8_t Version{1};
+// difficulty byte of a request that takes any difficulty
+constexpr std::uint8_t AnyDifficulty{0xff};
+
+enum class Status : std::uint8_t {
+  Ok = 0,
+  // the pool of the difficulty is empty, try again later
+  Empty = 1,
+  // the daemon doesn't pool sudokus of the size or the version differs
+  Unsupported = 2
+};
+
+struct Request {
+  std::uint8_t version{Version};
+  std::uint8_t size{};
+  std::uint8_t difficulty{AnyDifficulty};
+  std::uint8_t reserved{};
+};
+struct ResponseHeader {
+  Status status{Status::Ok};
+  std::uint8_t difficulty{};
+  // cells following the header, 0 unless the status is Ok
+  std::uint16_t cells{};
+};
+static_assert(sizeof(Request) == 4 && sizeof(ResponseHeader) == 4);
+
+struct PooledSudoku {
+  std::vector<SudokuValue> values{};
+  sudokuDifficulty::Difficulty difficulty{};
+};
+
+// Socket of the daemon, in XDG_RUNTIME_DIR when it is set, else in /tmp
+[[nodiscard]] std::string SocketPath();
+
+// Takes a sudoku from the daemon, a single round trip. Returns nothing when
+// no daemon listens, it has no sudoku of the size and difficulty or it
+// doesn't answer within a second
+[[nodiscard]] std::optional<PooledSudoku>
+Fetch(std::size_t size,
+      std::optional<sudokuDifficulty::Difficulty> difficulty = {},
+      const std::string &socketPath = SocketPath());
+
+// Sends or receives all bytes, retries short transfers and interrupts.
+// Returns false when the connection fails or closes first
+[[nodiscard]] bool SendAll(int fd, const void *data, std::size_t length);
+[[nodiscard]] bool ReceiveAll(int fd, void *data, std::size_t length);
+
+} // namespace sudokuPool
@@ -0,0 +1,63 @@
+#pragma once
+#include "sudokuCanonical.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+
+// Solutions of sudokus of a single size kept in a file mapped into memory.
+// Entries are keyed by the fingerprint of the canonical form (see
+// sudokuCanonical.h) and hold the solution of the canonical form, every
+// symmetric copy of a sudoku finds the same entry. The file holds buckets of
+// 8 entries, a full bucket evicts the entry its clock hand finds unused
+// since the hand last passed. Processes sharing the file lock it per call.
+class SolutionCache final {
+public:
+  enum class Entry : std::uint8_t { Missing, Solved, Unsolvable };
+
+  // Opens or makes the cache file for sudokus of the size holding about
+  // capacity entries, a file made for another size or capacity starts over.
+  // Throws when the file can't be opened or mapped
+  SolutionCache(const std::string &path, std::size_t size,
+                std::size_t capacity = std::size_t{1} << 16);
+  ~SolutionCache();
+  SolutionCache(const SolutionCache &) = delete;
+  SolutionCache(SolutionCache &&) = delete;
+  SolutionCache &operator=(const SolutionCache &) = delete;
+  SolutionCache &operator=(SolutionCache &&) = delete;
+
+  // Cache file of the size in XDG_CACHE_HOME, else in ~/.cache
+  [[nodiscard]] static std::string DefaultPath(std::size_t size);
+
+  // Looks up a canonical form, the labels of a solved one go to solution
+  [[nodiscard]] Entry Find(sudokuCanonical::Fingerprint fingerprint,
+                           std::span<std::uint8_t> solution);
+  // Keeps the solution (labels of the canonical form) of a canonical form
+  void Store(sudokuCanonical::Fingerprint fingerprint,
+             std::span<const std::uint8_t> solution);
+  // Keeps that a canonical form has no solution
+  void StoreUnsolvable(sudokuCanonical::Fingerprint fingerprint);
+
+  [[nodiscard]] std::size_t Size() const noexcept { return size; }
+
+private:
+  // Returns the slot of the fingerprint in its bucket, nothing if missing
+  [[nodiscard]] std::uint8_t *SlotOf(sudokuCanonical::Fingerprint fingerprint);
+  // Returns the slot to keep the fingerprint in, evicts when needed
+  [[nodiscard]] std::uint8_t *
+  FreeSlotOf(sudokuCanonical::Fingerprint fingerprint);
+  void Keep(sudokuCanonical::Fingerprint fingerprint, Entry entry,
+            std::span<const std::uint8_t> solution);
+
+  const std::size_t size;
+  // bits per packed cell and bytes per slot
+  const std::size_t cellBits;
+  const std::size_t slotBytes;
+  std::size_t buckets{};
+  int fd{-1};
+  std::uint8_t *pMapped{};
+  std::size_t mappedBytes{};
+  // threads of a process, other processes are kept out by a file lock
+  std::mutex mutex{};
+};
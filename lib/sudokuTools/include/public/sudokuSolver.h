@@ -1,9 +1,19 @@
 #pragma once
+#include "sudokuCanonical.h"
+#include "sudokuGrid.h"
 #include "sudokuHelpers.h"
+#include "sudokuSolutionCache.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <stop_token>
 #include <vector>
 
 class SudokuSolver_;
+class ThreadPool;
 
 struct Solver {
   Solver() = delete;
@@ -12,15 +22,49 @@ struct Solver {
       : size(size_), sectionSize(sectionSize_), solvertType(solverType_) {}
 
   std::vector<SudokuValue> values{};
+  // Threads searching a single sudoku, 1 searches on the calling thread.
+  // Only the bitstring solver splits its search
+  std::size_t threads{1};
+  // Ends the search when a stop is requested
+  std::stop_token stopToken{};
+  // Search nodes a single call may visit, 0 is unlimited
+  std::size_t nodeBudget{};
   const std::size_t size;
   const std::size_t sectionSize;
   const SolverTypes solvertType;
 };
 
+enum class SolveResult { Solved, Unsolvable, Cancelled, BudgetExceeded };
+
+struct BatchOptions {
+  SolverTypes solverType{SolverTypes::Bitstring};
+  // worker threads, 0 uses every core
+  std::size_t threads{0};
+  // puzzles a worker takes at once
+  std::size_t chunkSize{64};
+};
+
+enum class BatchStatus { Solved, Unsolvable, Invalid };
+
+struct BatchReport {
+  // status per puzzle, same order as the puzzles
+  std::vector<BatchStatus> statuses{};
+  std::size_t solved{};
+  std::size_t unsolvable{};
+  std::size_t invalid{};
+  // time the whole batch took
+  std::chrono::nanoseconds wallTime{};
+  // time all workers together spent solving
+  std::chrono::nanoseconds solveTime{};
+};
+
+// Keeps one solver backend per solver type, created on first use and reused
+// (including its buffers) by every following call. Not thread safe, use a
+// SudokuSolver per thread.
 class SudokuSolver {
 public:
-  SudokuSolver() = default;
-  ~SudokuSolver() = default;
+  SudokuSolver();
+  ~SudokuSolver();
   SudokuSolver(const SudokuSolver &) = delete;
   SudokuSolver(SudokuSolver &&) = delete;
   SudokuSolver &operator=(const SudokuSolver &) = delete;
@@ -30,9 +74,64 @@ public:
   [[nodiscard]] bool CanBePlaced(const Solver &solver, ValueLocation location,
                                  SudokuValue value);
   [[nodiscard]] bool ValidateSudoku(const Solver &solver) const;
-  [[nodiscard]] bool Solve(Solver &solver);
+  // Validates the sudoku and adds every pair of cells that share a row,
+  // column or square and hold the same value to conflicts
+  [[nodiscard]] bool
+  ValidateSudoku(const Solver &solver,
+                 std::vector<ValueConflict> &conflicts) const;
+  [[nodiscard]] SolveResult Solve(Solver &solver);
+  // Returns the amount of solutions, stops searching once limit solutions are
+  // found. A limit of 2 is enough to check if a solution is unique.
+  // A cancelled search returns the solutions found so far, see LastSearch
+  [[nodiscard]] std::size_t CountSolutions(const Solver &solver,
+                                           std::size_t limit);
+  // Returns the nodes and the stop reason of the last search
+  [[nodiscard]] const SearchStats &LastSearch() const noexcept;
+  // Drops all state the backends kept from previous calls, their buffers stay
+  // allocated
+  void Reset();
+  // Solve and CanBeSolved look the sudoku up in the cache before searching
+  // and add what the search finds. Sudokus with more clues than holes and
+  // sudokus whose canonical form takes too long skip the cache. A cache can
+  // be shared by solvers, nullptr stops using it
+  void UseCache(std::shared_ptr<SolutionCache> pCache_);
+  // Solves every puzzle into the solution on the same index, spread over a
+  // thread pool that is kept for the next batch. Every worker has its own
+  // solver, workers only share an atomic puzzle index. Instantiated for the
+  // box sizes VisitGrid supports
+  template <std::size_t Box>
+  [[nodiscard]] BatchReport SolveBatch(std::span<const Grid<Box>> puzzles,
+                                       std::span<Grid<Box>> solutions,
+                                       const BatchOptions &options);
 
 private:
-  std::unique_ptr<SudokuSolver_>
-  GetRequiredSolver(const SolverTypes solvertType) const;
+  static constexpr std::size_t SolverTypesCount{
+      static_cast<std::size_t>(SolverTypes::Bitboard) + 1};
+
+  SudokuSolver_ &GetRequiredSolver(const SolverTypes solvertType) const;
+  // Returns the backend of the solver with the budget of the solver started
+  SudokuSolver_ &StartSearch(const Solver &solver);
+  // Keeps the stats of the search the backend just ended
+  void EndSearch(const SudokuSolver_ &backend);
+  // Searches without the cache
+  [[nodiscard]] SolveResult Search(Solver &solver);
+  // Returns true if the cache takes the sudoku, keeps its fingerprint
+  [[nodiscard]] bool CacheKeyOf(const Solver &solver);
+  // Looks the sudoku of the last key up, a solution goes to pValues
+  [[nodiscard]] SolutionCache::Entry
+  FindCached(std::vector<SudokuValue> *pValues);
+  // Adds the result of a search on the sudoku of the last key to the cache
+  void Cache(SolveResult result, const std::vector<SudokuValue> &solution);
+
+  SearchStats lastSearch{};
+  std::shared_ptr<SolutionCache> pCache{};
+  sudokuCanonical::Canonicalizer canonicalizer{};
+  sudokuCanonical::Fingerprint cacheKey{};
+  // solution in labels of the canonical form
+  std::vector<std::uint8_t> cachedSolution{};
+  mutable std::array<std::unique_ptr<SudokuSolver_>, SolverTypesCount>
+      solvers{};
+  std::unique_ptr<ThreadPool> pBatchPool{};
+  // one solver per batch worker
+  std::vector<std::unique_ptr<SudokuSolver>> batchSolvers{};
 };
\ No newline at end of file
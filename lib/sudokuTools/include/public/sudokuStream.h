@@ -0,0 +1,102 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Lazily produced sequence, a minimal std::generator (C++23) for C++20.
+// The coroutine only runs up to its next co_yield when the caller increments,
+// so the caller sets the pace. Yielded values are referenced, not copied: a
+// value stays valid until the next increment.
+template <typename T> class Stream final {
+public:
+  struct promise_type {
+    const T *pValue{};
+    std::exception_ptr exception{};
+
+    Stream get_return_object() noexcept {
+      return Stream{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    std::suspend_always yield_value(const T &value) noexcept {
+      pValue = std::addressof(value);
+      return {};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept {
+      exception = std::current_exception();
+    }
+  };
+  using Handle = std::coroutine_handle<promise_type>;
+
+  class Iterator {
+  public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    explicit Iterator(Handle handle_) : handle(handle_) {}
+
+    [[nodiscard]] const T &operator*() const noexcept {
+      return *handle.promise().pValue;
+    }
+    [[nodiscard]] const T *operator->() const noexcept {
+      return handle.promise().pValue;
+    }
+    Iterator &operator++() {
+      Resume(handle);
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept {
+      return !handle || handle.done();
+    }
+
+  private:
+    Handle handle{};
+  };
+
+  Stream(Stream &&other) noexcept
+      : handle(std::exchange(other.handle, nullptr)) {}
+  Stream &operator=(Stream &&other) noexcept {
+    if (this != &other) {
+      Destroy();
+      handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+  }
+  Stream(const Stream &) = delete;
+  Stream &operator=(const Stream &) = delete;
+  ~Stream() { Destroy(); }
+
+  // Runs the coroutine to its first co_yield, call once
+  [[nodiscard]] Iterator begin() {
+    Resume(handle);
+    return Iterator{handle};
+  }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  explicit Stream(Handle handle_) : handle(handle_) {}
+
+  // Runs to the next co_yield, rethrows what the coroutine threw
+  static void Resume(Handle handle) {
+    if (!handle || handle.done()) {
+      return;
+    }
+    handle.resume();
+    if (handle.promise().exception) {
+      std::rethrow_exception(std::exchange(handle.promise().exception, {}));
+    }
+  }
+  void Destroy() noexcept {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  Handle handle{};
+};
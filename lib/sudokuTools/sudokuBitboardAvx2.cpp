@@ -0,0 +1,84 @@
+#include "sudokuBitboard.h"
+#include "sudokuBitboardKernel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// Compiled with -mavx2 -mbmi -mpopcnt, only called when the cpu supports it.
+// A board still is a 128 bit register, operations over all 9 digit boards
+// handle 2 boards per 256 bit register.
+
+namespace {
+struct Avx2Ops {
+  using Board = __m128i;
+
+  static Board Load(const bitboard::Mask &mask) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(&mask));
+  }
+  static Board Zero() noexcept { return _mm_setzero_si128(); }
+  static Board And(Board a, Board b) noexcept { return _mm_and_si128(a, b); }
+  static Board AndNot(Board a, Board b) noexcept {
+    return _mm_andnot_si128(b, a);
+  }
+  static Board Or(Board a, Board b) noexcept { return _mm_or_si128(a, b); }
+  static bool IsZero(Board a) noexcept { return _mm_testz_si128(a, a); }
+  static int Popcount(Board a) noexcept {
+    return __builtin_popcountll(_mm_cvtsi128_si64(a)) +
+           __builtin_popcountll(_mm_extract_epi64(a, 1));
+  }
+  static std::size_t LowestCell(Board a) noexcept {
+    const auto lo{static_cast<std::uint64_t>(_mm_cvtsi128_si64(a))};
+    return lo ? __builtin_ctzll(lo)
+              : 64 + __builtin_ctzll(_mm_extract_epi64(a, 1));
+  }
+  static void ClearCell(Board *digits, Board cell) noexcept {
+    const auto cells{_mm256_broadcastsi128_si256(cell)};
+    for (std::size_t digit{}; digit + 1 < bitboard::Size; digit += 2) {
+      auto *pPair{reinterpret_cast<__m256i *>(digits + digit)};
+      _mm256_storeu_si256(
+          pPair, _mm256_andnot_si256(cells, _mm256_loadu_si256(pPair)));
+    }
+    digits[bitboard::Size - 1] =
+        _mm_andnot_si128(cell, digits[bitboard::Size - 1]);
+  }
+  static void Accumulate(const Board *digits, Board &once, Board &twice,
+                         Board &thrice) noexcept {
+    // count per half: the even and the odd digits
+    auto pairOnce{_mm256_setzero_si256()};
+    auto pairTwice{_mm256_setzero_si256()};
+    auto pairThrice{_mm256_setzero_si256()};
+    for (std::size_t digit{}; digit + 1 < bitboard::Size; digit += 2) {
+      const auto *pPair{reinterpret_cast<const __m256i *>(digits + digit)};
+      const auto pair{_mm256_loadu_si256(pPair)};
+      pairThrice =
+          _mm256_or_si256(pairThrice, _mm256_and_si256(pairTwice, pair));
+      pairTwice = _mm256_or_si256(pairTwice, _mm256_and_si256(pairOnce, pair));
+      pairOnce = _mm256_or_si256(pairOnce, pair);
+    }
+    // merge both halves
+    const auto onceA{_mm256_castsi256_si128(pairOnce)};
+    const auto onceB{_mm256_extracti128_si256(pairOnce, 1)};
+    const auto twiceA{_mm256_castsi256_si128(pairTwice)};
+    const auto twiceB{_mm256_extracti128_si256(pairTwice, 1)};
+    once = Or(onceA, onceB);
+    twice = Or(Or(twiceA, twiceB), And(onceA, onceB));
+    thrice = Or(Or(_mm256_castsi256_si128(pairThrice),
+                   _mm256_extracti128_si256(pairThrice, 1)),
+                Or(And(twiceA, onceB), And(onceA, twiceB)));
+    // the last digit
+    const auto last{digits[bitboard::Size - 1]};
+    thrice = Or(thrice, And(twice, last));
+    twice = Or(twice, And(once, last));
+    once = Or(once, last);
+  }
+};
+} // namespace
+
+namespace bitboard {
+std::size_t RunAvx2(const std::uint8_t *givens, std::uint8_t *solution,
+                    std::size_t limit, SearchBudget &budget) noexcept {
+  Kernel<Avx2Ops> kernel;
+  return kernel.Run(givens, solution, limit, budget);
+}
+} // namespace bitboard
@@ -0,0 +1,56 @@
+#include "sudokuBitboard.h"
+#include "sudokuBitboardKernel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+// Compiled with -msse4.1 -mpopcnt, only called when the cpu supports it
+
+namespace {
+struct Sse41Ops {
+  using Board = __m128i;
+
+  static Board Load(const bitboard::Mask &mask) noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(&mask));
+  }
+  static Board Zero() noexcept { return _mm_setzero_si128(); }
+  static Board And(Board a, Board b) noexcept { return _mm_and_si128(a, b); }
+  static Board AndNot(Board a, Board b) noexcept {
+    return _mm_andnot_si128(b, a);
+  }
+  static Board Or(Board a, Board b) noexcept { return _mm_or_si128(a, b); }
+  static bool IsZero(Board a) noexcept { return _mm_testz_si128(a, a); }
+  static int Popcount(Board a) noexcept {
+    return __builtin_popcountll(_mm_cvtsi128_si64(a)) +
+           __builtin_popcountll(_mm_extract_epi64(a, 1));
+  }
+  static std::size_t LowestCell(Board a) noexcept {
+    const auto lo{static_cast<std::uint64_t>(_mm_cvtsi128_si64(a))};
+    return lo ? __builtin_ctzll(lo)
+              : 64 + __builtin_ctzll(_mm_extract_epi64(a, 1));
+  }
+  static void ClearCell(Board *digits, Board cell) noexcept {
+    for (std::size_t digit{}; digit < bitboard::Size; digit++) {
+      digits[digit] = _mm_andnot_si128(cell, digits[digit]);
+    }
+  }
+  static void Accumulate(const Board *digits, Board &once, Board &twice,
+                         Board &thrice) noexcept {
+    once = twice = thrice = Zero();
+    for (std::size_t digit{}; digit < bitboard::Size; digit++) {
+      thrice = Or(thrice, And(twice, digits[digit]));
+      twice = Or(twice, And(once, digits[digit]));
+      once = Or(once, digits[digit]);
+    }
+  }
+};
+} // namespace
+
+namespace bitboard {
+std::size_t RunSse41(const std::uint8_t *givens, std::uint8_t *solution,
+                     std::size_t limit, SearchBudget &budget) noexcept {
+  Kernel<Sse41Ops> kernel;
+  return kernel.Run(givens, solution, limit, budget);
+}
+} // namespace bitboard
@@ -0,0 +1,487 @@
+#include "sudokuCanonical.h"
+#include "sudokuHelpers.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sudokuCanonical {
+
+// sudokus up to 64 wide, sections up to 8 wide
+static constexpr std::size_t MaxSize{64};
+static constexpr std::size_t MaxSection{8};
+// key of a digit without a label yet, above every label: the label it gets
+// is the next one
+static constexpr std::uint8_t NewDigit{0xff};
+// nodes between two polls of the stop token
+static constexpr std::size_t StopCheckInterval{1024};
+
+using Keys = std::array<std::uint8_t, MaxSection>;
+
+struct Canonicalizer::State {
+  // source stack on each stack of the canonical form
+  std::array<std::uint8_t, MaxSection> stackOf{};
+  // the stack starts a group of stacks no row so far tells apart
+  std::array<bool, MaxSection> stackStarts{};
+  // per source stack, the source column on each column of the stack
+  std::array<std::array<std::uint8_t, MaxSection>, MaxSection> columnOf{};
+  std::array<std::array<bool, MaxSection>, MaxSection> columnStarts{};
+  // source row on each row of the canonical form
+  std::array<std::uint8_t, MaxSize> rowOf{};
+  std::uint64_t usedRows{};
+  // label of each source digit, 0 until the digit appears
+  std::array<std::uint8_t, MaxSize + 1> labelOf{};
+  std::uint8_t nextLabel{1};
+};
+
+struct Canonicalizer::Search {
+  std::size_t size{};
+  std::size_t sectionSize{};
+  // the sudoku or its transpose, row major
+  const std::uint8_t *cells{};
+  bool transposed{};
+  // rows without a digit, swapping these keeps the sudoku the same
+  std::uint64_t emptyRows{};
+  // rows of the best form so far that the search agrees with
+  std::size_t bestRows{};
+  std::stop_token stopToken{};
+  std::size_t nodeBudget{};
+  std::size_t nodes{};
+  // out of nodes or stopped, the best form may not be the smallest
+  bool gaveUp{};
+};
+
+[[nodiscard]] static std::uint8_t
+KeyOf(std::uint8_t value,
+      const std::array<std::uint8_t, MaxSize + 1> &labelOf) noexcept {
+  if (!value) {
+    return 0;
+  }
+  return labelOf[value] ? labelOf[value] : NewDigit;
+}
+
+// Returns the rows of the band as a mask
+[[nodiscard]] static std::uint64_t
+BandMask(std::size_t band, std::size_t sectionSize) noexcept {
+  return ((std::uint64_t{1} << sectionSize) - 1) << (band * sectionSize);
+}
+
+std::span<const std::uint8_t>
+Canonicalizer::Canonicalize(std::span<const SudokuValue> values,
+                            std::size_t size, std::size_t sectionSize,
+                            std::stop_token stopToken,
+                            std::size_t nodeBudget) {
+  if (sectionSize * sectionSize != size || size > MaxSize ||
+      values.size() != size * size) {
+    throw std::runtime_error("unable to canonicalize a sudoku of size " +
+                             std::to_string(size));
+  }
+  grid.resize(values.size());
+  transposed.resize(values.size());
+  for (std::size_t i{}; i < values.size(); i++) {
+    const auto value{values[i].value_or(0)};
+    if (value > size) {
+      throw std::runtime_error("unable to canonicalize a sudoku with value " +
+                               std::to_string(value));
+    }
+    grid[i] = static_cast<std::uint8_t>(value);
+    transposed[(i % size) * size + i / size] = grid[i];
+  }
+  best.assign(values.size(), 0);
+  transform.cellOf.resize(values.size());
+  transform.valueOf.assign(size + 1, 0);
+
+  State start{};
+  for (std::size_t s{}; s < sectionSize; s++) {
+    start.stackOf[s] = static_cast<std::uint8_t>(s);
+    for (std::size_t i{}; i < sectionSize; i++) {
+      start.columnOf[s][i] = static_cast<std::uint8_t>(s * sectionSize + i);
+    }
+    start.columnStarts[s][0] = true;
+  }
+  start.stackStarts[0] = true;
+
+  Search search{size, sectionSize};
+  search.stopToken = std::move(stopToken);
+  search.nodeBudget = nodeBudget;
+  for (const auto isTransposed : {false, true}) {
+    search.cells = isTransposed ? transposed.data() : grid.data();
+    search.transposed = isTransposed;
+    search.emptyRows = 0;
+    for (std::size_t r{}; r < size; r++) {
+      const auto *row{search.cells + r * size};
+      if (std::all_of(row, row + size, [](auto v) { return v == 0; })) {
+        search.emptyRows |= std::uint64_t{1} << r;
+      }
+    }
+    PickRow(search, start, 0);
+  }
+  if (search.gaveUp) {
+    return {};
+  }
+  return best;
+}
+
+void Canonicalizer::SortRow(State &state, const std::uint8_t *row,
+                            std::size_t sectionSize, std::uint8_t *rowKeys) {
+  // stable insertion sorts, the groups are a few wide
+  std::array<Keys, MaxSection> contents{};
+  for (std::size_t s{}; s < sectionSize; s++) {
+    auto &columns{state.columnOf[s]};
+    auto &starts{state.columnStarts[s]};
+    auto &keys{contents[s]};
+    for (std::size_t i{}; i < sectionSize; i++) {
+      keys[i] = KeyOf(row[columns[i]], state.labelOf);
+    }
+    for (std::size_t begin{}; begin < sectionSize;) {
+      auto end{begin + 1};
+      while (end < sectionSize && !starts[end]) {
+        end++;
+      }
+      for (auto i{begin + 1}; i < end; i++) {
+        for (auto j{i}; j > begin && keys[j - 1] > keys[j]; j--) {
+          std::swap(keys[j - 1], keys[j]);
+          std::swap(columns[j - 1], columns[j]);
+        }
+      }
+      for (auto i{begin + 1}; i < end; i++) {
+        starts[i] = keys[i] != keys[i - 1];
+      }
+      begin = end;
+    }
+  }
+  auto &stacks{state.stackOf};
+  for (std::size_t begin{}; begin < sectionSize;) {
+    auto end{begin + 1};
+    while (end < sectionSize && !state.stackStarts[end]) {
+      end++;
+    }
+    for (auto i{begin + 1}; i < end; i++) {
+      for (auto j{i};
+           j > begin && contents[stacks[j]] < contents[stacks[j - 1]]; j--) {
+        std::swap(stacks[j - 1], stacks[j]);
+      }
+    }
+    for (auto i{begin + 1}; i < end; i++) {
+      state.stackStarts[i] = contents[stacks[i]] != contents[stacks[i - 1]];
+    }
+    begin = end;
+  }
+  for (std::size_t p{}; p < sectionSize; p++) {
+    std::copy_n(contents[stacks[p]].begin(), sectionSize,
+                rowKeys + p * sectionSize);
+  }
+}
+
+void Canonicalizer::PickRow(Search &search, const State &state,
+                            std::size_t depth) {
+  const auto size{search.size};
+  const auto sectionSize{search.sectionSize};
+  if (++search.nodes == search.nodeBudget ||
+      (!(search.nodes % StopCheckInterval) &&
+       search.stopToken.stop_requested())) {
+    search.gaveUp = true;
+  }
+  if (search.gaveUp) {
+    return;
+  }
+  if (depth == size) {
+    // the search only gets here on a form equal to the best one
+    for (std::size_t r{}; r < size; r++) {
+      for (std::size_t c{}; c < size; c++) {
+        const std::size_t row{state.rowOf[r]};
+        const std::size_t column{
+            state.columnOf[state.stackOf[c / sectionSize]][c % sectionSize]};
+        transform.cellOf[r * size + c] =
+            search.transposed ? column * size + row : row * size + column;
+      }
+    }
+    std::ranges::fill(transform.valueOf, 0);
+    for (std::size_t v{1}; v <= size; v++) {
+      if (state.labelOf[v]) {
+        transform.valueOf[state.labelOf[v]] = static_cast<unsigned int>(v);
+      }
+    }
+    return;
+  }
+
+  // a band starts with a row of any band left, else the rows of the band
+  std::uint64_t candidates{};
+  if (depth % sectionSize == 0) {
+    bool emptyBand{};
+    for (std::size_t band{}; band < sectionSize; band++) {
+      const auto mask{BandMask(band, sectionSize)};
+      if (state.usedRows & mask) {
+        continue;
+      }
+      // empty bands are all alike, so are empty rows of a band
+      const auto isEmpty{(search.emptyRows & mask) == mask};
+      if (isEmpty && std::exchange(emptyBand, true)) {
+        continue;
+      }
+      auto rows{mask & ~search.emptyRows};
+      if (const auto empty{mask & search.emptyRows}) {
+        rows |= empty & (~empty + 1);
+      }
+      candidates |= rows;
+    }
+  } else {
+    const auto mask{BandMask(state.rowOf[depth - depth % sectionSize] /
+                                 sectionSize,
+                             sectionSize)};
+    candidates = mask & ~state.usedRows & ~search.emptyRows;
+    if (const auto empty{mask & ~state.usedRows & search.emptyRows}) {
+      candidates |= empty & (~empty + 1);
+    }
+  }
+
+  // only the rows giving the smallest row go on
+  std::array<std::uint8_t, MaxSize> smallest{};
+  std::array<std::uint8_t, MaxSize> keys{};
+  std::uint64_t smallestRows{};
+  for (std::size_t r{}; r < size; r++) {
+    if (!(candidates >> r & 1)) {
+      continue;
+    }
+    State sorted{state};
+    SortRow(sorted, search.cells + r * size, sectionSize, keys.data());
+    // new digits get labels in the order they appear
+    auto label{state.nextLabel};
+    for (std::size_t i{}; i < size; i++) {
+      if (keys[i] == NewDigit) {
+        keys[i] = label++;
+      }
+    }
+    const auto order{smallestRows
+                         ? std::memcmp(keys.data(), smallest.data(), size)
+                         : -1};
+    if (order < 0) {
+      smallest = keys;
+      smallestRows = 0;
+    }
+    if (order <= 0) {
+      smallestRows |= std::uint64_t{1} << r;
+    }
+  }
+  auto *bestRow{best.data() + depth * size};
+  if (depth < search.bestRows) {
+    const auto order{std::memcmp(smallest.data(), bestRow, size)};
+    if (order > 0) {
+      return;
+    }
+    if (order < 0) {
+      std::copy_n(smallest.begin(), size, bestRow);
+      search.bestRows = depth + 1;
+    }
+  } else {
+    std::copy_n(smallest.begin(), size, bestRow);
+    search.bestRows = depth + 1;
+  }
+
+  for (std::size_t r{}; r < size; r++) {
+    if (!(smallestRows >> r & 1)) {
+      continue;
+    }
+    State next{state};
+    SortRow(next, search.cells + r * size, sectionSize, keys.data());
+    next.rowOf[depth] = static_cast<std::uint8_t>(r);
+    next.usedRows |= std::uint64_t{1} << r;
+    Individualize(search, next, depth, r);
+  }
+}
+
+void Canonicalizer::Individualize(Search &search, State &state,
+                                  std::size_t depth, std::size_t row) {
+  const auto sectionSize{search.sectionSize};
+  const auto *values{search.cells + row * search.size};
+  const auto isNew{[&state, values](std::uint8_t column) {
+    return values[column] && !state.labelOf[values[column]];
+  }};
+  if (search.gaveUp) {
+    return;
+  }
+
+  // stacks alike but for new digits: each of them can come first
+  for (std::size_t begin{}; begin < sectionSize;) {
+    auto end{begin + 1};
+    while (end < sectionSize && !state.stackStarts[end]) {
+      end++;
+    }
+    const auto &columns{state.columnOf[state.stackOf[begin]]};
+    if (end - begin > 1 &&
+        std::any_of(columns.begin(), columns.begin() + sectionSize, isNew)) {
+      for (auto i{begin}; i < end; i++) {
+        // a stack a symmetry maps onto an earlier one gives the same forms
+        const auto stack{state.stackOf[i]};
+        const auto alike{[&](std::size_t j) {
+          const auto other{state.stackOf[j]};
+          return state.columnStarts[other] == state.columnStarts[stack] &&
+                 IsSymmetry(search, state, row, state.columnOf[other].data(),
+                            state.columnOf[stack].data(), sectionSize);
+        }};
+        if (std::ranges::any_of(std::views::iota(begin, i), alike)) {
+          continue;
+        }
+        State branch{state};
+        std::swap(branch.stackOf[begin], branch.stackOf[i]);
+        branch.stackStarts[begin + 1] = true;
+        Individualize(search, branch, depth, row);
+      }
+      return;
+    }
+    begin = end;
+  }
+  // columns of a stack alike but for new digits
+  for (std::size_t p{}; p < sectionSize; p++) {
+    const auto stack{state.stackOf[p]};
+    const auto &columns{state.columnOf[stack]};
+    const auto &starts{state.columnStarts[stack]};
+    for (std::size_t begin{}; begin < sectionSize;) {
+      auto end{begin + 1};
+      while (end < sectionSize && !starts[end]) {
+        end++;
+      }
+      if (end - begin > 1 && isNew(columns[begin])) {
+        for (auto i{begin}; i < end; i++) {
+          const auto alike{[&](std::size_t j) {
+            return IsSymmetry(search, state, row, &columns[j], &columns[i], 1);
+          }};
+          if (std::ranges::any_of(std::views::iota(begin, i), alike)) {
+            continue;
+          }
+          State branch{state};
+          std::swap(branch.columnOf[stack][begin], branch.columnOf[stack][i]);
+          branch.columnStarts[stack][begin + 1] = true;
+          Individualize(search, branch, depth, row);
+        }
+        return;
+      }
+      begin = end;
+    }
+  }
+
+  // the order is fixed, the new digits get their labels
+  for (std::size_t p{}; p < sectionSize; p++) {
+    for (std::size_t i{}; i < sectionSize; i++) {
+      const auto value{values[state.columnOf[state.stackOf[p]][i]]};
+      if (value && !state.labelOf[value]) {
+        state.labelOf[value] = state.nextLabel++;
+      }
+    }
+  }
+  PickRow(search, state, depth + 1);
+}
+
+bool Canonicalizer::IsSymmetry(const Search &search, const State &state,
+                               std::size_t row, const std::uint8_t *a,
+                               const std::uint8_t *b, std::size_t count) {
+  const auto size{search.size};
+  const auto *values{search.cells + row * size};
+  std::array<std::uint8_t, MaxSize> columnOf{};
+  std::array<std::uint8_t, MaxSize + 1> digitOf{};
+  for (std::size_t c{}; c < size; c++) {
+    columnOf[c] = static_cast<std::uint8_t>(c);
+  }
+  for (std::size_t v{}; v <= size; v++) {
+    digitOf[v] = static_cast<std::uint8_t>(v);
+  }
+  for (std::size_t i{}; i < count; i++) {
+    columnOf[a[i]] = b[i];
+    columnOf[b[i]] = a[i];
+    const auto x{values[a[i]]};
+    const auto y{values[b[i]]};
+    if (x == y) {
+      continue;
+    }
+    // the digits the rows so far labeled stay
+    if (!x || !y || state.labelOf[x] || state.labelOf[y]) {
+      return false;
+    }
+    digitOf[x] = y;
+    digitOf[y] = x;
+  }
+  for (std::size_t r{}; r < size; r++) {
+    const auto *cells{search.cells + r * size};
+    for (std::size_t c{}; c < size; c++) {
+      if (digitOf[cells[c]] != cells[columnOf[c]]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Finalizer of splitmix64
+[[nodiscard]] static constexpr std::uint64_t Mix(std::uint64_t x) noexcept {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
+Fingerprint FingerprintOf(std::span<const std::uint8_t> canonical) noexcept {
+  // two lanes over 8 cells at a time, the same on any byte order
+  Fingerprint fingerprint{0x9e3779b97f4a7c15 ^ canonical.size(),
+                          0xc2b2ae3d27d4eb4f + canonical.size()};
+  for (std::size_t i{}; i < canonical.size(); i += 8) {
+    std::uint64_t word{};
+    for (std::size_t j{}; j < 8 && i + j < canonical.size(); j++) {
+      word |= std::uint64_t{canonical[i + j]} << (8 * j);
+    }
+    fingerprint.high = Mix(fingerprint.high ^ word);
+    fingerprint.low = Mix(fingerprint.low + word * 0x9fb21c651e98df25 +
+                          (fingerprint.high >> 17));
+  }
+  // an empty slot of a FingerprintSet is all zero
+  if (fingerprint == Fingerprint{}) {
+    fingerprint.low = 1;
+  }
+  return fingerprint;
+}
+
+bool FingerprintSet::Insert(Fingerprint fingerprint) {
+  // at most half full, probes stay short
+  if ((count + 1) * 2 > slots.size()) {
+    Grow();
+  }
+  auto &slot{slots[SlotOf(fingerprint)]};
+  if (slot == fingerprint) {
+    return false;
+  }
+  slot = fingerprint;
+  count++;
+  return true;
+}
+
+bool FingerprintSet::Contains(Fingerprint fingerprint) const noexcept {
+  return !slots.empty() && slots[SlotOf(fingerprint)] == fingerprint;
+}
+
+std::size_t FingerprintSet::SlotOf(Fingerprint fingerprint) const noexcept {
+  const auto mask{slots.size() - 1};
+  auto slot{fingerprint.low & mask};
+  while (slots[slot] != fingerprint && slots[slot] != Fingerprint{}) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void FingerprintSet::Grow() {
+  auto old{std::move(slots)};
+  slots.assign(std::max<std::size_t>(old.size() * 2, 1024), Fingerprint{});
+  for (const auto &fingerprint : old) {
+    if (fingerprint != Fingerprint{}) {
+      slots[SlotOf(fingerprint)] = fingerprint;
+    }
+  }
+}
+
+} // namespace sudokuCanonical
@@ -0,0 +1,131 @@
+#include "sudokuCanonical.h"
+#include "sudokuGenerator.h"
+#include "sudokuHelpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Every symmetric copy of a sudoku has the same canonical form, and the
+// transform of a canonical form maps it back to the sudoku it was made from
+
+// symmetric copies canonicalized per sudoku
+static constexpr int Copies{20};
+
+// Returns true if the transform shows the sudoku on the canonical form
+static bool MapsBack(std::span<const std::uint8_t> canonical,
+                     const sudokuCanonical::Transform &transform,
+                     std::span<const SudokuValue> values) {
+  for (std::size_t i{}; i < canonical.size(); i++) {
+    const auto &value{values[transform.cellOf[i]]};
+    if (canonical[i] ? value != transform.valueOf[canonical[i]]
+                     : value.has_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Canonicalizes the sudoku and Copies transforms of it (bands, rows, stacks,
+// columns permuted, digits relabeled, maybe transposed), returns false if a
+// form differs or doesn't map back
+static bool ExpectSameForms(const char *name, std::size_t size,
+                            const std::vector<SudokuValue> &values) {
+  sudokuCanonical::Canonicalizer canonicalizer{};
+  const auto sectionSize{SectionSizeOf(size)};
+  const auto form{canonicalizer.Canonicalize(values, size, sectionSize)};
+  const std::vector<std::uint8_t> expected{form.begin(), form.end()};
+  if (expected.empty() ||
+      !MapsBack(expected, canonicalizer.LastTransform(), values)) {
+    std::printf("%s: no canonical form mapping back\n", name);
+    return false;
+  }
+
+  SudokuGenerator generator{};
+  Generator transformer{size, sectionSize, std::chrono::seconds{10},
+                        GeneratorTypes::Transform};
+  transformer.seed = 2024;
+  transformer.transformSeeds.push_back(values);
+  int differing{};
+  for (int i{}; i < Copies; i++) {
+    if (generator.Generate(transformer) != GenerateResult::Generated) {
+      std::printf("%s: transform failed\n", name);
+      return false;
+    }
+    const auto copy{canonicalizer.Canonicalize(transformer.values, size,
+                                               sectionSize)};
+    if (!std::ranges::equal(copy, expected) ||
+        !MapsBack(copy, canonicalizer.LastTransform(), transformer.values)) {
+      differing++;
+    }
+  }
+  // the canonical form is its own canonical form
+  std::vector<SudokuValue> canonical{};
+  for (const auto label : expected) {
+    canonical.push_back(label ? SudokuValue{label} : SudokuValue{});
+  }
+  const auto again{canonicalizer.Canonicalize(canonical, size, sectionSize)};
+  if (!std::ranges::equal(again, expected)) {
+    differing++;
+  }
+  std::printf("%s: %d of %d copies differ\n", name, differing, Copies + 1);
+  return differing == 0;
+}
+
+static Generator MakeGenerator(std::size_t size, DigOrder digOrder) {
+  Generator config{size, SectionSizeOf(size), std::chrono::seconds{10},
+                   GeneratorTypes::Shift};
+  config.seed = 2024;
+  config.digOrder = digOrder;
+  return config;
+}
+
+int main() {
+  bool passed{true};
+  SudokuGenerator generator{};
+
+  for (const auto size : {std::size_t{4}, std::size_t{9}}) {
+    const auto sizeName{std::to_string(size) + "x" + std::to_string(size)};
+    auto grid{MakeGenerator(size, DigOrder::Random)};
+    if (!generator.GenerateGrid(grid)) {
+      std::printf("full %s: grid failed\n", sizeName.c_str());
+      return EXIT_FAILURE;
+    }
+    passed &= ExpectSameForms(("full " + sizeName).c_str(), size, grid.values);
+
+    // a symmetric sudoku has symmetries the search prunes
+    for (const auto &[digOrder, orderName] :
+         {std::pair{DigOrder::Random, "random"},
+          std::pair{DigOrder::RotationalPairs, "rotational"},
+          std::pair{DigOrder::MirrorPairs, "mirror"}}) {
+      const auto name{std::string{orderName} + " " + sizeName};
+      auto dug{MakeGenerator(size, digOrder)};
+      if (generator.Generate(dug) != GenerateResult::Generated) {
+        std::printf("%s: generation failed\n", name.c_str());
+        return EXIT_FAILURE;
+      }
+      passed &= ExpectSameForms(name.c_str(), size, dug.values);
+    }
+  }
+
+  // an empty sudoku maps onto itself in every way
+  passed &= ExpectSameForms("empty 9x9", 9, std::vector<SudokuValue>(81));
+
+  // a search out of nodes gives up
+  auto grid{MakeGenerator(9, DigOrder::Random)};
+  sudokuCanonical::Canonicalizer canonicalizer{};
+  const bool gaveUp{generator.GenerateGrid(grid) &&
+                    canonicalizer.Canonicalize(grid.values, 9, 3, {}, 1)
+                        .empty()};
+  std::printf("full 9x9 with 1 node: %s\n", gaveUp ? "gave up" : "finished");
+  passed &= gaveUp;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
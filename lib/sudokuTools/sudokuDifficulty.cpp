@@ -1,8 +1,7 @@
 #include "sudokuDifficulty.h"
 #include "sudokuHelpers.h"
-#include <algorithm>
-#include <map>
-#include <ranges>
+#include <cstddef>
+#include <span>
 
 // The difficulty score:
 // Add or subtract a score for each condition
@@ -31,117 +30,143 @@ static const int SpecificValueMissingMoreThanTwo = 5;
 
 static const int FewMissing = 9;
 
-namespace sudokuDifficulty {
-Difficulty GetDifficulty(unsigned int score);
+// Score of every condition for its current count, the total score is the sum
+// over all rows, columns, squares and values
 
-Difficulty CalculateDifficulty(const std::vector<SudokuValue> &sudoku,
-                               const std::size_t size,
-                               const std::size_t sectionSize) {
-  static const SudokuValue EMPTY_VALUE = SudokuValue();
+[[nodiscard]] static int TotalScore(std::size_t missing) noexcept {
+  return missing < FewMissing ? ScoreDelta::FewMissing : 0;
+}
 
-  auto score(static_cast<int>(Difficulty::normal));
+[[nodiscard]] static int SquareScore(std::size_t missing) noexcept {
+  if (missing == 0) {
+    return ScoreDelta::NoMissingInSquare;
+  }
+  if (missing == 1) {
+    return ScoreDelta::OnlyOneInSquare;
+  }
+  return missing >= 3 ? ScoreDelta::MoreThanThreeInSquare : 0;
+}
 
-  // total
-  {
-    const auto missingCount{
-        std::count(sudoku.begin(), sudoku.end(), EMPTY_VALUE)};
-    if (missingCount < FewMissing) {
-      score += ScoreDelta::FewMissing;
-    }
+[[nodiscard]] static int LineScore(std::size_t missing) noexcept {
+  if (missing == 1) {
+    return ScoreDelta::OnlyOneInLine;
   }
+  return missing >= 3 ? ScoreDelta::MoreThanThreeInLine : 0;
+}
 
-  // specific numbers
-  {
-    for (auto valueIdx : std::ranges::iota_view(0, static_cast<int>(size))) {
-      const auto missingCount =
-          std::count(sudoku.begin(), sudoku.end(), SudokuValue(valueIdx));
-      if (missingCount == 0) {
-        score += ScoreDelta::SpecificValueNoMissing;
-      } else if (missingCount == 1) {
-        score += ScoreDelta::SpecificValueSingleMissing;
-      } else {
-        score += ScoreDelta::SpecificValueMissingMoreThanTwo;
-      }
+// count is the amount of cells holding the value, values 0 up to size - 1 are
+// scored on their count, values 1 up to size on the rows and on the columns
+[[nodiscard]] static int ValueScore(unsigned int value, std::size_t count,
+                                    std::size_t size) noexcept {
+  int score{};
+  if (value < size) {
+    if (count == 0) {
+      score += ScoreDelta::SpecificValueNoMissing;
+    } else if (count == 1) {
+      score += ScoreDelta::SpecificValueSingleMissing;
+    } else {
+      score += ScoreDelta::SpecificValueMissingMoreThanTwo;
     }
   }
+  if (value > 0 && count == size - 1) {
+    score += 2 * ScoreDelta::OnlyOneOfNumberInAdjLines;
+  }
+  return score;
+}
 
-  // square
-  {
-    for (auto squareIdx : std::ranges::iota_view(0, static_cast<int>(size))) {
-      auto allIndexesOfSqr{GetAllIndexesOfSquare(size, sectionSize, squareIdx)};
-      unsigned int missingCount{0};
-      for (auto idx : allIndexesOfSqr) {
-        if (sudoku.at(idx) == EMPTY_VALUE) {
-          missingCount++;
-        }
-      }
+namespace sudokuDifficulty {
+Difficulty GetDifficulty(unsigned int score);
+
+Difficulty CalculateDifficulty(std::span<const SudokuValue> sudoku,
+                               const std::size_t size,
+                               const std::size_t sectionSize) {
+  DifficultyScore score{};
+  score.Reset(sudoku, size, sectionSize);
+  return score.GetDifficulty();
+}
 
-      if (missingCount == 0) {
-        score += ScoreDelta::NoMissingInSquare;
-      } else if (missingCount == 1) {
-        score += ScoreDelta::OnlyOneInSquare;
-      } else if (missingCount >= 3) {
-        score += ScoreDelta::MoreThanThreeInSquare;
+void DifficultyScore::Reset(std::span<const SudokuValue> sudoku,
+                            std::size_t size_, std::size_t sectionSize_) {
+  size = size_;
+  sectionSize = sectionSize_;
+  rowMissing.assign(size, 0);
+  columnMissing.assign(size, 0);
+  squareMissing.assign(size, 0);
+  valueCount.assign(size + 1, 0);
+  missing = 0;
+  for (std::size_t idx{}; idx < sudoku.size(); idx++) {
+    if (sudoku[idx].has_value()) {
+      if (*sudoku[idx] <= size) {
+        valueCount[*sudoku[idx]]++;
       }
+      continue;
     }
+    missing++;
+    rowMissing[idx / size]++;
+    columnMissing[idx % size]++;
+    squareMissing[SquareOf(idx)]++;
   }
 
-  // columns
-  {
-    std::map<unsigned int, unsigned int> columnValuesCount{};
-    for (auto columnIdx : std::ranges::iota_view(0, static_cast<int>(size))) {
-      auto allIndexesOfColumn{GetAllIndexesOfColumn(size, columnIdx)};
-      unsigned int missingCount{0};
-      for (auto idx : allIndexesOfColumn) {
-        if (sudoku.at(idx) == EMPTY_VALUE) {
-          missingCount++;
-        } else {
-          columnValuesCount[sudoku.at(idx).value()]++;
-        }
-      }
+  score = static_cast<int>(Difficulty::normal) + TotalScore(missing);
+  for (std::size_t i{}; i < size; i++) {
+    score += SquareScore(squareMissing[i]) + LineScore(rowMissing[i]) +
+             LineScore(columnMissing[i]);
+  }
+  for (unsigned int value{}; value <= size; value++) {
+    score += ValueScore(value, valueCount[value], size);
+  }
+}
 
-      if (missingCount == 1) {
-        score += ScoreDelta::OnlyOneInLine;
-      } else if (missingCount >= 3) {
-        score += ScoreDelta::MoreThanThreeInLine;
-      }
-    }
+void DifficultyScore::Remove(std::size_t idx, unsigned int value) noexcept {
+  Update(idx, value, 1);
+}
 
-    for (auto valueCount : columnValuesCount) {
-      if (valueCount.second == size - 1) {
-        score += ScoreDelta::OnlyOneOfNumberInAdjLines;
-      }
-    }
-  }
+void DifficultyScore::Place(std::size_t idx, unsigned int value) noexcept {
+  Update(idx, value, -1);
+}
 
-  // rows
-  {
-    std::map<unsigned int, unsigned int> rowValuesCount{};
-    for (auto lineIdx : std::ranges::iota_view(0, static_cast<int>(size))) {
-      auto allIndexesOfRow{GetAllIndexesOfRow(size, lineIdx)};
-      unsigned int missingCount{0};
-      for (auto idx : allIndexesOfRow) {
-        if (sudoku.at(idx) == EMPTY_VALUE) {
-          missingCount++;
-        } else {
-          rowValuesCount[sudoku.at(idx).value()]++;
-        }
-      }
+Difficulty DifficultyScore::GetDifficulty() const noexcept {
+  return sudokuDifficulty::GetDifficulty(score < 0 ? 0 : score);
+}
 
-      if (missingCount == 1) {
-        score += ScoreDelta::OnlyOneInLine;
-      } else if (missingCount >= 3) {
-        score += ScoreDelta::MoreThanThreeInLine;
-      }
-    }
-    for (auto valueCount : rowValuesCount) {
-      if (valueCount.second == size - 1) {
-        score += ScoreDelta::OnlyOneOfNumberInAdjLines;
-      }
-    }
+void DifficultyScore::Update(std::size_t idx, unsigned int value,
+                             int missingDelta) noexcept {
+  const auto apply{[missingDelta](std::size_t &count) {
+    count = static_cast<std::size_t>(static_cast<int>(count) + missingDelta);
+  }};
+
+  score -= TotalScore(missing);
+  apply(missing);
+  score += TotalScore(missing);
+
+  auto &row{rowMissing[idx / size]};
+  score -= LineScore(row);
+  apply(row);
+  score += LineScore(row);
+
+  auto &column{columnMissing[idx % size]};
+  score -= LineScore(column);
+  apply(column);
+  score += LineScore(column);
+
+  auto &square{squareMissing[SquareOf(idx)]};
+  score -= SquareScore(square);
+  apply(square);
+  score += SquareScore(square);
+
+  if (value <= size) {
+    auto &count{valueCount[value]};
+    score -= ValueScore(value, count, size);
+    // a missing cell more is a value less
+    count = static_cast<std::size_t>(static_cast<int>(count) - missingDelta);
+    score += ValueScore(value, count, size);
   }
+}
 
-  return GetDifficulty(score < 0 ? 0 : score);
+std::size_t DifficultyScore::SquareOf(std::size_t idx) const noexcept {
+  const auto r{idx / size};
+  const auto c{idx % size};
+  return (r / sectionSize) * sectionSize + c / sectionSize;
 }
 
 Difficulty GetDifficulty(unsigned int score) {
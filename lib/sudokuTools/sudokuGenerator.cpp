@@ -1,30 +1,43 @@
 #include "sudokuGenerator.h"
+#include "sudokuDifficulty.h"
 #include "sudokuGenerator_.h"
 #include "sudokuHelpers.h"
 #include "sudokuSolver.h"
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <ranges>
+#include <span>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 //===============
 // private generator functions
 ///===============
 enum class FillStyle { RowBased, SquareBased };
+// index tables of a generation live on the stack, bigger sudokus can't be
+// solved anyway
+constexpr std::size_t MaxSize{64};
 
-void None(Generator &){};
-void Shuffle(Generator &generator);
-void Shift(Generator &generator);
+void None(Generator &, SudokuGenerator_::Engine &){};
+void Shuffle(Generator &generator, SudokuGenerator_::Engine &engine);
+void Shift(Generator &generator, SudokuGenerator_::Engine &engine);
+void Transform(Generator &generator, SudokuGenerator_::Engine &engine);
 
 void Fill(Generator &generator, FillStyle squareBased);
-void ShuffleRowsColumns(Generator &generator);
+void ShuffleRowsColumns(Generator &generator,
+                        SudokuGenerator_::Engine &engine);
+
+// Returns the cell dug together with the cell, the cell itself without a pair
+[[nodiscard]] std::size_t PartnerOf(const Generator &generator,
+                                    std::size_t idx) noexcept;
 
-void PokeHoles(Generator &generator, Solver &solver,
-               std::function<bool(const Solver &)> sudokuValidator);
 //================
 // public library functions
 ///================
@@ -34,15 +47,43 @@ SudokuGenerator::SudokuGenerator()
 
 SudokuGenerator::~SudokuGenerator() {}
 
-bool SudokuGenerator::Generate(Generator &generator) {
+GenerateResult SudokuGenerator::Generate(Generator &generator) {
+  if (generator.size >= MaxSize) {
+    throw std::runtime_error("Generator sudoku size too big");
+  }
   InitiateGenerator(generator);
   return pSudokuGenerator->Generate(generator);
 }
 
+bool SudokuGenerator::GenerateGrid(Generator &generator) {
+  if (generator.size >= MaxSize) {
+    throw std::runtime_error("Generator sudoku size too big");
+  }
+  InitiateGenerator(generator);
+  return pSudokuGenerator->GenerateGrid(generator);
+}
+
+Stream<GeneratedSudoku> SudokuGenerator::GenerateStream(Generator &generator) {
+  GeneratedSudoku sudoku{};
+  // rates every sudoku with the same buffers
+  sudokuDifficulty::DifficultyScore score{};
+  while (Generate(generator) == GenerateResult::Generated) {
+    sudoku.values = generator.values;
+    score.Reset(generator.values, generator.size, generator.sectionSize);
+    sudoku.difficulty = score.GetDifficulty();
+    sudoku.solverCalls = SolverCalls();
+    co_yield sudoku;
+  }
+}
+
 unsigned int SudokuGenerator::TotalTries() const {
   return pSudokuGenerator->TotalTries();
 }
 
+std::size_t SudokuGenerator::SolverCalls() const {
+  return pSudokuGenerator->SolverCalls();
+}
+
 void SudokuGenerator::Reset() { pSudokuGenerator->Reset(); }
 
 void SudokuGenerator::InitiateGenerator(Generator &generator) {
@@ -56,6 +97,13 @@ void SudokuGenerator::InitiateGenerator(Generator &generator) {
     pSudokuGenerator->SetGenerateFunction(Shift);
     fillStyle = FillStyle::RowBased;
     break;
+  case GeneratorTypes::Transform:
+    // starts from the seeds, not from a full grid
+    if (generator.transformSeeds.empty()) {
+      throw std::runtime_error("Transform generator without seed sudokus");
+    }
+    pSudokuGenerator->SetGenerateFunction(Transform);
+    return;
   case GeneratorTypes::None:
     pSudokuGenerator->SetGenerateFunction(None);
   default:
@@ -68,152 +116,450 @@ void SudokuGenerator::InitiateGenerator(Generator &generator) {
 // private library functions
 ///================
 
-SudokuGenerator_::SudokuGenerator_()
-    : pSudokuSolver(std::make_unique<SudokuSolver>()), generateFunction(None) {}
+SudokuGenerator_::SudokuGenerator_() : SudokuGenerator_(None) {}
 
-SudokuGenerator_::SudokuGenerator_(
-    std::function<void(Generator &)> generateFunction_)
-    : pSudokuSolver(std::make_unique<SudokuSolver>()),
-      generateFunction(generateFunction_) {}
+SudokuGenerator_::SudokuGenerator_(GenerateFunction generateFunction_)
+    : generateFunction(generateFunction_),
+      engine((static_cast<std::uint64_t>(std::random_device{}()) << 32) |
+             std::random_device{}()),
+      pSudokuSolver(std::make_unique<SudokuSolver>()) {}
 
 unsigned int SudokuGenerator_::TotalTries() const { return totalTries; }
 
+std::size_t SudokuGenerator_::SolverCalls() const { return solverCalls; }
+
 void SudokuGenerator_::SetGenerateFunction(
-    std::function<void(Generator &)> generateFunction_) {
+    GenerateFunction generateFunction_) {
   generateFunction = generateFunction_;
 }
 
 void SudokuGenerator_::Reset() { totalTries = 0; }
 
-bool SudokuGenerator_::Generate(Generator &generator) {
-  Solver solver(generator.size, generator.sectionSize, SolverTypes::Bitstring);
+GenerateResult SudokuGenerator_::Generate(Generator &generator) {
+  solverCalls = 0;
+  SeedEngine(generator);
+  // a transform keeps the single solution of its seed, nothing to search
+  if (generator.generatorType == GeneratorTypes::Transform) {
+    totalTries++;
+    generateFunction(generator, engine);
+    return GenerateResult::Generated;
+  }
+
+  auto &solver{DigSolver(generator)};
   auto startT{std::chrono::steady_clock::now()};
+  spentNodes = 0;
+  searchStop = SearchStop::None;
 
   auto timeleft{std::chrono::steady_clock::now() - startT};
   Log::Debug("Starting sudoku generation...");
-  const auto oValues{generator.values};
+  originalValues = generator.values;
   do {
+    if (generator.stopToken.stop_requested()) {
+      Log::Debug("Sudoku generation cancelled...");
+      return GenerateResult::Cancelled;
+    }
     totalTries++;
     timeleft = std::chrono::steady_clock::now() - startT;
-    generateFunction(generator);
+    generateFunction(generator, engine);
     solver.values = generator.values;
-    PokeHoles(generator, solver,
-              std::bind(&SudokuSolver::ValidateSudoku, pSudokuSolver.get(),
-                        std::placeholders::_1));
-    if (pSudokuSolver->ValidateSudoku(solver)) {
-      Log::Debug("validated sudoku!");
-      return true;
+    if (!pSudokuSolver->ValidateSudoku(solver)) {
+      generator.values = originalValues;
+      continue;
+    }
+
+    switch (PokeHoles(generator, solver)) {
+    case SearchStop::Cancelled:
+      Log::Debug("Sudoku generation cancelled...");
+      generator.values = originalValues;
+      return GenerateResult::Cancelled;
+    case SearchStop::BudgetExceeded:
+      Log::Debug("Sudoku generation ran out of search budget...");
+      generator.values = originalValues;
+      return GenerateResult::BudgetExceeded;
+    case SearchStop::None:
+      break;
+    }
+
+    const auto clues{static_cast<std::size_t>(std::ranges::count_if(
+        generator.values, [](const auto &v) { return v.has_value(); }))};
+    if ((!generator.targetClues || clues <= generator.targetClues) &&
+        (!generator.targetDifficulty ||
+         difficultyScore.GetDifficulty() == *generator.targetDifficulty)) {
+      Log::Debug("Sudoku generated...");
+      return GenerateResult::Generated;
     }
-    generator.values = oValues;
+    // minimal above the clue target or below the difficulty, try another grid
+    generator.values = originalValues;
   } while (generator.maxGenerationTime > timeleft);
   Log::Debug("Unable to generate sudoku in time...");
+  return GenerateResult::TimedOut;
+}
+
+bool SudokuGenerator_::GenerateGrid(Generator &generator) {
+  SeedEngine(generator);
+  totalTries++;
+  generateFunction(generator, engine);
+  auto &solver{DigSolver(generator)};
+  solver.values = generator.values;
+  return pSudokuSolver->ValidateSudoku(solver);
+}
+
+void SudokuGenerator_::SeedEngine(const Generator &generator) noexcept {
+  if (generator.seed && generator.seed != seededWith) {
+    engine.Seed(*generator.seed);
+    seededWith = generator.seed;
+  }
+}
+
+Solver &SudokuGenerator_::DigSolver(const Generator &generator) {
+  // the solutions are counted for every poked hole, the bitboard solver is the
+  // fastest but only solves 9x9. Bigger sudokus prove a single solution
+  // fastest with dancing links
+  const auto solverType{generator.size == 9 ? SolverTypes::Bitboard
+                                            : SolverTypes::DancingLinks};
+  if (!digSolver || digSolver->size != generator.size ||
+      digSolver->sectionSize != generator.sectionSize ||
+      digSolver->solvertType != solverType) {
+    digSolver.emplace(generator.size, generator.sectionSize, solverType);
+  }
+  return *digSolver;
+}
+
+SearchStop SudokuGenerator_::PokeHoles(Generator &generator, Solver &solver) {
+  const auto cellCount{generator.values.size()};
+  // a pair is dug from its first cell
+  digOrder.clear();
+  for (std::size_t idx{}; idx < cellCount; idx++) {
+    if (PartnerOf(generator, idx) >= idx) {
+      digOrder.push_back(idx);
+    }
+  }
+  engine.Shuffle(digOrder.begin(), digOrder.end());
+
+  // holes are poked in the solver values, the generator gets the result
+  solver.values = generator.values;
+  difficultyScore.Reset(solver.values, generator.size, generator.sectionSize);
+  rowMasks.assign(generator.size, 0);
+  columnMasks.assign(generator.size, 0);
+  squareMasks.assign(generator.size, 0);
+  neededClues.assign(cellCount, false);
+  for (std::size_t idx{}; idx < cellCount; idx++) {
+    if (solver.values[idx].has_value()) {
+      ToggleMasks(generator, idx, *solver.values[idx]);
+    }
+  }
+  auto clues{static_cast<std::size_t>(std::ranges::count_if(
+      solver.values, [](const auto &v) { return v.has_value(); }))};
+  const auto clueTarget{generator.minimal ? 0 : generator.targetClues};
+  for (std::size_t i{}; i < digOrder.size(); i++) {
+    if (clueTarget && clues <= clueTarget) {
+      break;
+    }
+    if (generator.digOrder == DigOrder::MostConstrained) {
+      // the order behind i is random, the first clue with the fewest
+      // candidates goes next
+      auto best{i};
+      auto bestCount{generator.size + 1};
+      for (auto j{i}; j < digOrder.size() && bestCount > 1; j++) {
+        const auto count{static_cast<std::size_t>(
+            std::popcount(CandidatesOf(generator, digOrder[j])))};
+        if (count < bestCount) {
+          best = j;
+          bestCount = count;
+        }
+      }
+      std::swap(digOrder[i], digOrder[best]);
+    }
+    const auto idx{digOrder[i]};
+    const std::array pair{idx, PartnerOf(generator, idx)};
+    const std::span cells{pair.data(), pair[0] == pair[1] ? 1u : 2u};
+    if (TryRemove(generator, solver, cells, true)) {
+      clues -= cells.size();
+    } else if (searchStop != SearchStop::None) {
+      break;
+    }
+  }
+
+  // a clue that can't go can't go with fewer clues either, a single pass over
+  // the clues left makes the sudoku minimal. Pairs stay pairs, so symmetric
+  // orders keep their symmetry
+  for (std::size_t idx{}; generator.minimal && idx < cellCount &&
+                          searchStop == SearchStop::None;
+       idx++) {
+    const std::array pair{idx, PartnerOf(generator, idx)};
+    if (pair[1] < idx || !solver.values[idx].has_value() || neededClues[idx]) {
+      continue;
+    }
+    const std::span cells{pair.data(), pair[0] == pair[1] ? 1u : 2u};
+    static_cast<void>(TryRemove(generator, solver, cells, false));
+  }
+  generator.values = solver.values;
+  return searchStop;
+}
+
+bool SudokuGenerator_::TryRemove(const Generator &generator, Solver &solver,
+                                 std::span<const std::size_t> cells,
+                                 bool checkDifficulty) {
+  // a single cell or a pair
+  std::array<unsigned int, 2> values{};
+  for (std::size_t i{}; i < cells.size(); i++) {
+    values[i] = *solver.values[cells[i]];
+    solver.values[cells[i]].reset();
+    difficultyScore.Remove(cells[i], values[i]);
+    ToggleMasks(generator, cells[i], values[i]);
+  }
+  const auto putBack{[&]() {
+    for (std::size_t i{}; i < cells.size(); i++) {
+      solver.values[cells[i]] = values[i];
+      difficultyScore.Place(cells[i], values[i]);
+      ToggleMasks(generator, cells[i], values[i]);
+    }
+  }};
+
+  // backs off the holes that rate the sudoku too hard, before solving
+  if (checkDifficulty && generator.targetDifficulty &&
+      difficultyScore.GetDifficulty() > *generator.targetDifficulty) {
+    putBack();
+    return false;
+  }
+  // holes forced by the clues left can't add a solution
+  bool forced{true};
+  for (std::size_t i{}; i < cells.size() && forced; i++) {
+    forced = IsForced(generator, solver, cells[i], values[i]);
+  }
+  if (forced) {
+    return true;
+  }
+
+  solverCalls++;
+  StartSearch(generator, solver);
+  const auto count{pSudokuSolver->CountSolutions(solver, 2)};
+  if (!EndSearch(generator)) {
+    putBack();
+    return false;
+  }
+  if (count == 1) {
+    return true;
+  }
+  putBack();
+  // pairs are always tried together
+  for (const auto idx : cells) {
+    neededClues[idx] = true;
+  }
   return false;
 }
 
+bool SudokuGenerator_::IsForced(const Generator &generator,
+                                const Solver &solver, std::size_t idx,
+                                unsigned int value) const noexcept {
+  const auto bit{std::uint64_t{1} << (value - 1)};
+  // the only candidate of the hole
+  if (CandidatesOf(generator, idx) == bit) {
+    return true;
+  }
+  // the only place for the value in a row, column or square
+  const auto size{generator.size};
+  const auto sectionSize{generator.sectionSize};
+  const auto onlyPlace{[&](auto cellOf) {
+    for (std::size_t i{}; i < size; i++) {
+      const auto cell{cellOf(i)};
+      if (cell != idx && !solver.values[cell].has_value() &&
+          (CandidatesOf(generator, cell) & bit)) {
+        return false;
+      }
+    }
+    return true;
+  }};
+  const auto r{idx / size};
+  const auto c{idx % size};
+  const auto squareIdx{SudokuPosSquareIndex(size, sectionSize, idx).value()};
+  const auto square{GetIndexOfSquare(size, sectionSize, squareIdx).value()};
+  return onlyPlace([&](std::size_t i) { return r * size + i; }) ||
+         onlyPlace([&](std::size_t i) { return i * size + c; }) ||
+         onlyPlace([&](std::size_t i) {
+           return square + (i / sectionSize) * size + i % sectionSize;
+         });
+}
+
+void SudokuGenerator_::ToggleMasks(const Generator &generator, std::size_t idx,
+                                   unsigned int value) noexcept {
+  const auto bit{std::uint64_t{1} << (value - 1)};
+  rowMasks[idx / generator.size] ^= bit;
+  columnMasks[idx % generator.size] ^= bit;
+  squareMasks[SudokuPosSquareIndex(generator.size, generator.sectionSize, idx)
+                  .value()] ^= bit;
+}
+
+std::uint64_t
+SudokuGenerator_::CandidatesOf(const Generator &generator,
+                               std::size_t idx) const noexcept {
+  const auto all{(std::uint64_t{1} << generator.size) - 1};
+  const auto used{
+      rowMasks[idx / generator.size] | columnMasks[idx % generator.size] |
+      squareMasks[SudokuPosSquareIndex(generator.size, generator.sectionSize,
+                                       idx)
+                      .value()]};
+  return all & ~used;
+}
+
+void SudokuGenerator_::StartSearch(const Generator &generator,
+                                   Solver &solver) const noexcept {
+  solver.stopToken = generator.stopToken;
+  solver.nodeBudget = 0;
+  if (generator.nodeBudget) {
+    // a budget of 0 is unlimited, 1 stops the search at its first check
+    solver.nodeBudget = generator.nodeBudget > spentNodes
+                            ? generator.nodeBudget - spentNodes
+                            : 1;
+  }
+}
+
+bool SudokuGenerator_::EndSearch(const Generator &generator) noexcept {
+  const auto &stats{pSudokuSolver->LastSearch()};
+  spentNodes += stats.nodes;
+  searchStop = stats.stop;
+  // searches smaller than the check interval of the solver never stop, the
+  // budget of the generation is checked after every search
+  if (searchStop == SearchStop::None && generator.nodeBudget &&
+      spentNodes > generator.nodeBudget) {
+    searchStop = SearchStop::BudgetExceeded;
+  }
+  return searchStop == SearchStop::None;
+}
+
 //===============
 // private generator functions
 ///===============
 
+std::size_t PartnerOf(const Generator &generator, std::size_t idx) noexcept {
+  const auto size{generator.size};
+  switch (generator.digOrder) {
+  case DigOrder::RotationalPairs:
+    return size * size - 1 - idx;
+  case DigOrder::MirrorPairs:
+    return (idx / size) * size + size - 1 - idx % size;
+  case DigOrder::Random:
+  case DigOrder::MostConstrained:
+  default:
+    return idx;
+  }
+}
+
 void Fill(Generator &generator, FillStyle fillStyle) {
+  // the generate functions shuffle a full grid, a previous sudoku has holes
   if (generator.values.empty() ||
-      (generator.values.size() != (generator.size * generator.size))) {
+      (generator.values.size() != (generator.size * generator.size)) ||
+      std::ranges::any_of(generator.values,
+                          [](const auto &v) { return !v.has_value(); })) {
     generator.values.resize(generator.size * generator.size);
+    const auto size{generator.size};
     const auto sectionSize{generator.sectionSize};
 
-    std::function<int()> g{};
-    switch (fillStyle) {
-    case FillStyle::SquareBased:
-      g = [sectionSize]() -> int {
-        static int r{};
-        static int c{};
-        if (r == 9) {
-          r = 0;
-        }
-        if (c == 9) {
-          r++;
-          c = 0;
-        }
-
-        auto v = ((++c - 1) % sectionSize) + 1;
-        v += ((r % sectionSize) * sectionSize);
-
-        return v;
-      };
-
-      break;
-    case FillStyle::RowBased:
-    default:
-      g = []() -> int {
-        static int c{};
-        if (c == 9) {
-          c = 0;
-        }
-        return ++c;
-      };
-      break;
+    // the value of a cell follows from its row and column
+    for (std::size_t idx{}; idx < generator.values.size(); idx++) {
+      const auto r{idx / size};
+      const auto c{idx % size};
+      switch (fillStyle) {
+      case FillStyle::SquareBased:
+        generator.values[idx] = static_cast<unsigned int>(
+            (c % sectionSize) + 1 + (r % sectionSize) * sectionSize);
+        break;
+      case FillStyle::RowBased:
+      default:
+        generator.values[idx] = static_cast<unsigned int>(c + 1);
+        break;
+      }
     }
-
-    std::ranges::generate(generator.values, g);
   }
 }
 
-void Shuffle(Generator &generator) {
-  std::random_device rd;
-  std::mt19937_64 g(rd());
-  for (auto sqrIdx :
-       std::ranges::iota_view{0, static_cast<int>(generator.size)}) {
-    // Get the indexes of the value array corresponding to the sudoku square
-    auto idxs{
-        GetAllIndexesOfSquare(generator.size, generator.sectionSize, sqrIdx)};
-    const auto originalIdxs{idxs};
-    std::shuffle(idxs.begin(), idxs.end(), g);
-    // Swap the actual values according to the shuffles indexes
-    auto itValuesBegin{generator.values.begin()};
-    std::ranges::for_each(idxs, [&itValuesBegin, originalIdxs](auto idx) {
-      std::swap(itValuesBegin[originalIdxs[idx]], itValuesBegin[idx]);
-    });
+void Shuffle(Generator &generator, SudokuGenerator_::Engine &engine) {
+  const auto size{generator.size};
+  const auto sectionSize{generator.sectionSize};
+  std::array<SudokuValue, MaxSize> squareValues{};
+  for (std::size_t sqrIdx{}; sqrIdx < size; sqrIdx++) {
+    // the value index of the i-th value of the square
+    const auto first{GetIndexOfSquare(size, sectionSize, sqrIdx).value()};
+    const auto idxOf{[first, size, sectionSize](std::size_t i) {
+      return first + (i / sectionSize) * size + i % sectionSize;
+    }};
+    for (std::size_t i{}; i < size; i++) {
+      squareValues[i] = generator.values[idxOf(i)];
+    }
+    engine.Shuffle(squareValues.begin(), squareValues.begin() + size);
+    for (std::size_t i{}; i < size; i++) {
+      generator.values[idxOf(i)] = squareValues[i];
+    }
   }
 }
 
-void Shift(Generator &generator) {
+void Shift(Generator &generator, SudokuGenerator_::Engine &engine) {
   // randomize first row
-  // set second row by shifting first row by n1
-  // set third row by shifting seconds row by n1
-
-  // set fourth row by shifting third row by 1
-  // set fifth row by shifting fourth row by n2
-  //  ...
+  // rows in the same band: shift the previous row by the section size
+  // first row of a band: shift the previous row by 1
   // https://gamedev.stackexchange.com/a/138228
   // randomize the first row
-  std::random_device rd;
-  std::mt19937_64 g{rd()};
-  std::shuffle(generator.values.begin(),
-               generator.values.begin() + generator.size, g);
-  // shift each row by some amount
-  static const std::array<std::pair<int, int>, 8> lineShiftOrder{
-      {{1, 3}, {2, 3}, {3, 1}, {4, 3}, {5, 3}, {6, 1}, {7, 3}, {8, 3}}};
-
-  std::ranges::for_each(lineShiftOrder, [&generator](auto lineShift) {
-    for (auto i : std::ranges::iota_view(0, static_cast<int>(generator.size))) {
-      auto shiftTo{i + lineShift.second};
+  engine.Shuffle(generator.values.begin(),
+                 generator.values.begin() + generator.size);
+  const auto size{generator.size};
+  for (std::size_t row{1}; row < size; row++) {
+    const auto shift{row % generator.sectionSize ? generator.sectionSize : 1};
+    auto itPrevRow{generator.values.begin() + (row - 1) * size};
+    auto itBegin{generator.values.begin() + row * size};
+    for (std::size_t i{}; i < size; i++) {
       // wrap around
-      if (shiftTo >= generator.size) {
-        shiftTo -= generator.size;
-      }
-      auto itPrevRow{generator.values.begin() +
-                     (lineShift.first - 1) * generator.size};
-      auto itBegin{generator.values.begin() + lineShift.first * generator.size};
-      *(itBegin + i) = *(itPrevRow + shiftTo);
+      *(itBegin + i) = *(itPrevRow + (i + shift) % size);
     }
-  });
+  }
   // ShelldokuPrinter::PrintSingleLine(generator.values);
-  ShuffleRowsColumns(generator);
+  ShuffleRowsColumns(generator, engine);
   // ShelldokuPrinter::PrintSingleLine(generator.values);
 }
 
-void ShuffleRowsColumns(Generator &generator) {
-  std::random_device rd;
-  std::mt19937 g{rd()};
+void Transform(Generator &generator, SudokuGenerator_::Engine &engine) {
+  const auto size{generator.size};
+  const auto box{generator.sectionSize};
+  const auto &seed{generator.transformSeeds[engine.Bounded(
+      generator.transformSeeds.size())]};
+  if (seed.size() != size * size) {
+    throw std::runtime_error("Transform seed does not fit the sudoku size");
+  }
+
+  // rows: shuffle the bands, then the rows within every band. Same for columns
+  const auto fillLines{[&engine, size, box](auto &lines) {
+    std::array<std::size_t, MaxSize> bands{};
+    std::iota(bands.begin(), bands.begin() + box, 0);
+    engine.Shuffle(bands.begin(), bands.begin() + box);
+    for (std::size_t b{}; b < box; b++) {
+      auto itBand{lines.begin() + b * box};
+      std::iota(itBand, itBand + box, bands[b] * box);
+      engine.Shuffle(itBand, itBand + box);
+    }
+  }};
+  std::array<std::size_t, MaxSize> rows{};
+  std::array<std::size_t, MaxSize> columns{};
+  fillLines(rows);
+  fillLines(columns);
+  // digits[v] replaces value v, 0 stays unused
+  std::array<unsigned int, MaxSize + 1> digits{};
+  std::iota(digits.begin(), digits.begin() + size + 1, 0);
+  engine.Shuffle(digits.begin() + 1, digits.begin() + size + 1);
+  const bool transpose{static_cast<bool>(engine.Next() & 1)};
+
+  generator.values.resize(size * size);
+  for (std::size_t r{}; r < size; r++) {
+    for (std::size_t c{}; c < size; c++) {
+      const auto from{transpose ? columns[c] * size + rows[r]
+                                : rows[r] * size + columns[c]};
+      const auto &v{seed[from]};
+      generator.values[r * size + c] =
+          v.has_value() ? SudokuValue{digits[*v]} : SudokuValue{};
+    }
+  }
+}
+
+void ShuffleRowsColumns(Generator &generator,
+                        SudokuGenerator_::Engine &engine) {
   const auto sudokuSize{generator.size};
   const int sectionSize{static_cast<int>(generator.sectionSize)};
   // shuffle the lines, but move rows/columns as 1 unit
@@ -223,25 +569,18 @@ void ShuffleRowsColumns(Generator &generator) {
   // Shufflers containing the index of the row/column,
   // both row and column indexes are stored in a single container
   // These are shuffled later
-  std::vector<int> shuffler{};
-  shuffler.resize(sudokuSize * 2);
-  auto shufflerFiller{[sudokuSize]() {
-    static int i{};
-    if (i == sudokuSize) {
-      i = 0;
-    }
-    return i++;
-  }};
-  std::ranges::generate(shuffler, shufflerFiller);
+  std::array<int, 2 * MaxSize> shuffler{};
   auto itRowsBegin{shuffler.begin()};
   auto itColumnsBegin{shuffler.begin() + sudokuSize};
+  std::iota(itRowsBegin, itColumnsBegin, 0);
+  std::iota(itColumnsBegin, itColumnsBegin + sudokuSize, 0);
   // shuffle in pairs of 3 (don't cross square bariers)
   for (auto sectionIdx : std::ranges::iota_view{0, sectionSize}) {
     auto itRowsSectionBegin{itRowsBegin + sectionSize * sectionIdx};
     auto itColumnsSectionBegin{itColumnsBegin + sectionSize * sectionIdx};
     // shuffle shufflers
-    std::shuffle(itRowsSectionBegin, itRowsSectionBegin + sectionSize, g);
-    std::shuffle(itColumnsSectionBegin, itColumnsSectionBegin + sectionSize, g);
+    engine.Shuffle(itRowsSectionBegin, itRowsSectionBegin + sectionSize);
+    engine.Shuffle(itColumnsSectionBegin, itColumnsSectionBegin + sectionSize);
 
     // move the rows and columns according to the shufflers
     for (auto shuffleIdx : std::ranges::iota_view{0, sectionSize}) {
@@ -261,56 +600,14 @@ void ShuffleRowsColumns(Generator &generator) {
       if (itColumnsBegin[rcIdx] == rcIdx) {
         continue;
       }
-      // Because the column values are not next to eachother in the values
-      // container, first get the indexes, copy the values into a new container,
-      // reorder the values according to the shuffler, store them back into the
-      // values container.
-
-      // the indexes of the values in the values container at the current
-      // (incremental) column
-      auto cIndexes{GetAllIndexesOfColumn(sudokuSize, rcIdx)};
-      // the indexes of the values in the values container at the columns we're
-      // swapping with
-      auto shufflerIndexes{
-          GetAllIndexesOfColumn(sudokuSize, itColumnsBegin[rcIdx])};
-
-      for (auto cItIndxs{cIndexes.begin()},
-           itShufflerIndxs{shufflerIndexes.begin()};
-           cItIndxs != cIndexes.end() &&
-           itShufflerIndxs != shufflerIndexes.end();
-           cItIndxs++, itShufflerIndxs++) {
-        std::swap(generator.values[*cItIndxs],
-                  generator.values[*itShufflerIndxs]);
+      // the column values are a row length apart in the values container
+      const auto c1{static_cast<std::size_t>(rcIdx)};
+      const auto c2{static_cast<std::size_t>(itColumnsBegin[rcIdx])};
+      for (std::size_t rowStart{}; rowStart < sudokuSize * sudokuSize;
+           rowStart += sudokuSize) {
+        std::swap(generator.values[rowStart + c1],
+                  generator.values[rowStart + c2]);
       }
     }
   }
 }
-
-void PokeHoles(Generator &generator, Solver &solver,
-               std::function<bool(const Solver &)> sudokuValidator) {
-  std::random_device rd;
-  std::default_random_engine e{rd()};
-  static std::uniform_int_distribution<int> uniformDistr(0, generator.size *
-                                                                generator.size);
-  int randomIdx{uniformDistr(e)};
-
-  static int cntHoles{};
-  auto itV{generator.values.begin() + randomIdx};
-  // remove random value
-  if (!itV->has_value()) {
-    PokeHoles(generator, solver, sudokuValidator);
-  }
-  auto v{*itV};
-  itV->reset();
-  // is solvable?
-  solver.values = generator.values;
-  if (sudokuValidator(solver)) {
-    cntHoles++;
-  } else {
-    *itV = v;
-  }
-
-  if (cntHoles < 10) {
-    PokeHoles(generator, solver, sudokuValidator);
-  }
-}
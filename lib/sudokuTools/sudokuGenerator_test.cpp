@@ -0,0 +1,116 @@
+#include "sudokuGenerator.h"
+#include "sudokuHelpers.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <vector>
+
+// A steady state generation may not touch the heap, every allocation of the
+// process is counted while generating
+
+static std::atomic<std::size_t> allocations{};
+
+void *operator new(std::size_t size) {
+  allocations++;
+  if (auto *p{std::malloc(size ? size : 1)}) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  allocations++;
+  return std::malloc(size ? size : 1);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return operator new(size, std::nothrow);
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+// generations before counting, buffers grow to their final size
+static constexpr int WarmUp{3};
+static constexpr int Counted{20};
+
+// Generates WarmUp + Counted sudokus, returns false if the counted ones
+// allocated or failed
+static bool ExpectNoAllocations(const char *name, SudokuGenerator &generator,
+                                Generator &config) {
+  for (int i{}; i < WarmUp; i++) {
+    if (generator.Generate(config) != GenerateResult::Generated) {
+      std::printf("%s: warm up failed\n", name);
+      return false;
+    }
+  }
+  const auto before{allocations.load()};
+  for (int i{}; i < Counted; i++) {
+    if (generator.Generate(config) != GenerateResult::Generated) {
+      std::printf("%s: generation failed\n", name);
+      return false;
+    }
+  }
+  const auto count{allocations.load() - before};
+  std::printf("%s: %zu allocations in %d generations\n", name, count, Counted);
+  return count == 0;
+}
+
+static Generator MakeGenerator(std::size_t size, GeneratorTypes type) {
+  Generator config{size, SectionSizeOf(size), std::chrono::seconds{10}, type};
+  config.seed = 2024;
+  return config;
+}
+
+int main() {
+  bool passed{true};
+  SudokuGenerator generator{};
+
+  auto minimal{MakeGenerator(9, GeneratorTypes::Shift)};
+  passed &= ExpectNoAllocations("minimal 9x9", generator, minimal);
+
+  auto clues{MakeGenerator(9, GeneratorTypes::Shift)};
+  clues.targetClues = 30;
+  passed &= ExpectNoAllocations("30 clue 9x9", generator, clues);
+
+  auto hard{MakeGenerator(9, GeneratorTypes::Shift)};
+  hard.targetDifficulty = sudokuDifficulty::Difficulty::hard;
+  passed &= ExpectNoAllocations("hard 9x9", generator, hard);
+
+  auto symmetric{MakeGenerator(9, GeneratorTypes::Shift)};
+  symmetric.digOrder = DigOrder::RotationalPairs;
+  symmetric.minimal = true;
+  passed &= ExpectNoAllocations("minimal symmetric 9x9", generator, symmetric);
+
+  auto transform{MakeGenerator(9, GeneratorTypes::Transform)};
+  transform.transformSeeds.push_back(minimal.values);
+  passed &= ExpectNoAllocations("transform 9x9", generator, transform);
+
+  auto big{MakeGenerator(16, GeneratorTypes::Shift)};
+  big.targetClues = 180;
+  passed &= ExpectNoAllocations("180 clue 16x16", generator, big);
+
+  // the coroutine frame is allocated once, pulling sudokus is free
+  auto streamed{MakeGenerator(9, GeneratorTypes::Shift)};
+  auto stream{generator.GenerateStream(streamed)};
+  auto it{stream.begin()};
+  for (int i{}; i < WarmUp && it != std::default_sentinel; i++) {
+    ++it;
+  }
+  const auto before{allocations.load()};
+  int pulled{};
+  for (; pulled < Counted && it != std::default_sentinel; pulled++) {
+    ++it;
+  }
+  const auto count{allocations.load() - before};
+  std::printf("stream 9x9: %zu allocations in %d generations\n", count,
+              pulled);
+  passed &= count == 0 && pulled == Counted;
+
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -2,10 +2,15 @@
 #include "sudokuDifficulty.h"
 #include "sudokuHelpers.h"
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
 #include <fstream>
 #include <ios>
 #include <iterator>
+#include <span>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace sudokuParser {
@@ -15,12 +20,41 @@ int LinesOfFile(std::ifstream file) {
                     std::istreambuf_iterator<char>(), '\n');
 }
 
-void ParseToFile(const std::vector<SudokuValue> &values,
+void AppendLine(std::string &buffer, std::span<const SudokuValue> values,
+                sudokuDifficulty::Difficulty difficulty) {
+  // same line as ParseToString, without a string per value
+  std::array<char, 16> number{};
+  const auto appendNumber{[&buffer, &number](unsigned int n) {
+    const auto [end, ec]{
+        std::to_chars(number.data(), number.data() + number.size(), n)};
+    buffer.append(number.data(), end);
+  }};
+  appendNumber(static_cast<unsigned int>(difficulty));
+  buffer += '-';
+  for (std::size_t i{}; i < values.size(); i++) {
+    if (i) {
+      buffer += ',';
+    }
+    if (values[i].has_value()) {
+      appendNumber(*values[i]);
+    } else {
+      buffer += 'x';
+    }
+  }
+  buffer += '\n';
+}
+
+std::string ParseToLine(std::span<const SudokuValue> values,
+                        sudokuDifficulty::Difficulty difficulty) {
+  std::string str{};
+  AppendLine(str, values, difficulty);
+  return str;
+}
+
+void ParseToFile(std::span<const SudokuValue> values,
                  sudokuDifficulty::Difficulty difficulty,
                  const std::string &file) {
-  auto str = std::to_string(static_cast<unsigned int>(difficulty)) + "-" +
-             ParseToString(values, ',');
-  str += "\n";
+  const auto str{ParseToLine(values, difficulty)};
   std::ofstream f{file, std::ios::app};
   f.write(str.c_str(), str.size());
   f.close();
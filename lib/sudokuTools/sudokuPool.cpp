@@ -0,0 +1,103 @@
+#include "sudokuPool.h"
+#include "sudokuDifficulty.h"
+#include "sudokuHelpers.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+namespace sudokuPool {
+
+std::string SocketPath() {
+  const auto *runtimeDir{std::getenv("XDG_RUNTIME_DIR")};
+  return std::string(runtimeDir && *runtimeDir ? runtimeDir : "/tmp") +
+         "/shelldoku_generator.sock";
+}
+
+std::optional<PooledSudoku>
+Fetch(std::size_t size, std::optional<sudokuDifficulty::Difficulty> difficulty,
+      const std::string &socketPath) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    return {};
+  }
+  std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+  const auto fd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+  if (fd < 0) {
+    return {};
+  }
+  // a daemon that hangs can't hold up the game
+  const timeval timeout{1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  std::optional<PooledSudoku> sudoku{};
+  const Request request{
+      .size = static_cast<std::uint8_t>(size),
+      .difficulty = difficulty ? static_cast<std::uint8_t>(*difficulty)
+                               : AnyDifficulty};
+  ResponseHeader header{};
+  if (connect(fd, reinterpret_cast<const sockaddr *>(&address),
+              sizeof(address)) == 0 &&
+      SendAll(fd, &request, sizeof(request)) &&
+      ReceiveAll(fd, &header, sizeof(header)) &&
+      header.status == Status::Ok && header.cells == size * size) {
+    std::vector<std::uint8_t> cells(header.cells);
+    if (ReceiveAll(fd, cells.data(), cells.size())) {
+      sudoku.emplace();
+      sudoku->difficulty =
+          static_cast<sudokuDifficulty::Difficulty>(header.difficulty);
+      sudoku->values.reserve(cells.size());
+      for (const auto cell : cells) {
+        sudoku->values.emplace_back(cell ? SudokuValue{cell} : SudokuValue{});
+      }
+    }
+  }
+  close(fd);
+  return sudoku;
+}
+
+bool SendAll(int fd, const void *data, std::size_t length) {
+  const auto *bytes{static_cast<const std::uint8_t *>(data)};
+  while (length) {
+    const auto n{send(fd, bytes, length, MSG_NOSIGNAL)};
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    bytes += n;
+    length -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+bool ReceiveAll(int fd, void *data, std::size_t length) {
+  auto *bytes{static_cast<std::uint8_t *>(data)};
+  while (length) {
+    const auto n{recv(fd, bytes, length, 0)};
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    bytes += n;
+    length -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+} // namespace sudokuPool
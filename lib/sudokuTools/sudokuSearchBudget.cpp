@@ -0,0 +1,38 @@
+#include "sudokuSearchBudget.h"
+
+#include <atomic>
+#include <cstddef>
+#include <stop_token>
+#include <utility>
+
+void SearchBudget::Start(std::stop_token stopToken_,
+                         std::size_t nodeBudget_) noexcept {
+  stopToken = std::move(stopToken_);
+  nodeBudget = nodeBudget_;
+  spent = 0;
+  stop = SearchStop::None;
+}
+
+bool SearchBudget::Spend(std::size_t nodes) noexcept {
+  const auto total{spent.fetch_add(nodes, std::memory_order_relaxed) + nodes};
+  if (stop.load(std::memory_order_relaxed) != SearchStop::None) {
+    return true;
+  }
+  if (stopToken.stop_requested()) {
+    stop = SearchStop::Cancelled;
+    return true;
+  }
+  if (nodeBudget && total >= nodeBudget) {
+    stop = SearchStop::BudgetExceeded;
+    return true;
+  }
+  return false;
+}
+
+void SearchBudget::Count(std::size_t nodes) noexcept {
+  spent.fetch_add(nodes, std::memory_order_relaxed);
+}
+
+SearchStats SearchBudget::Stats() const noexcept {
+  return {spent.load(), stop.load()};
+}
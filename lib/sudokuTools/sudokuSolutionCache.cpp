@@ -0,0 +1,227 @@
+#include "sudokuSolutionCache.h"
+#include "sudokuCanonical.h"
+#include "sudokuHelpers.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr std::uint32_t Version{1};
+static constexpr std::size_t BucketSlots{8};
+// a bucket starts with its clock hand, padded to keep the slots aligned
+static constexpr std::size_t BucketHeaderBytes{8};
+// slot layout: fingerprint, entry, referenced bit, packed solution
+static constexpr std::size_t EntryOffset{sizeof(sudokuCanonical::Fingerprint)};
+static constexpr std::size_t ReferencedOffset{EntryOffset + 1};
+static constexpr std::size_t PackedOffset{ReferencedOffset + 1};
+
+struct Header {
+  char magic[8]{'S', 'H', 'D', 'K', 'S', 'O', 'L', 'V'};
+  std::uint32_t version{Version};
+  std::uint32_t size{};
+  std::uint64_t buckets{};
+  std::uint64_t slotBytes{};
+};
+static constexpr std::size_t HeaderBytes{64};
+static_assert(sizeof(Header) <= HeaderBytes);
+
+// Holds the file lock of the cache, other processes wait for it
+class FileLock final {
+public:
+  explicit FileLock(int fd_) : fd(fd_) { flock(fd, LOCK_EX); }
+  ~FileLock() { flock(fd, LOCK_UN); }
+  FileLock(const FileLock &) = delete;
+  FileLock &operator=(const FileLock &) = delete;
+
+private:
+  const int fd;
+};
+
+[[nodiscard]] static std::size_t CellBitsOf(std::size_t size) noexcept {
+  // labels 1 up to size are kept as 0 up to size - 1
+  return std::max<std::size_t>(std::bit_width(size - 1), 1);
+}
+
+[[nodiscard]] static std::size_t SlotBytesOf(std::size_t size) noexcept {
+  // a byte past the last cell, cells are read and written 2 bytes at a time
+  const auto bytes{PackedOffset + (size * size * CellBitsOf(size) + 7) / 8 +
+                   1};
+  return (bytes + 7) / 8 * 8;
+}
+
+SolutionCache::SolutionCache(const std::string &path, std::size_t size_,
+                             std::size_t capacity)
+    : size(size_), cellBits(CellBitsOf(size_)),
+      slotBytes(SlotBytesOf(size_)) {
+  const auto sectionSize{SectionSizeOf(size)};
+  if (!size || sectionSize * sectionSize != size || size > 64) {
+    throw std::runtime_error("unable to cache sudokus of size " +
+                             std::to_string(size));
+  }
+  buckets = std::bit_ceil(
+      std::max<std::size_t>((capacity + BucketSlots - 1) / BucketSlots, 1));
+  const auto bytes{HeaderBytes +
+                   buckets * (BucketHeaderBytes + BucketSlots * slotBytes)};
+
+  std::error_code ec{};
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path(), ec);
+  fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("unable to open the solution cache " + path);
+  }
+  {
+    FileLock lock{fd};
+    Header expected{};
+    expected.size = static_cast<std::uint32_t>(size);
+    expected.buckets = buckets;
+    expected.slotBytes = slotBytes;
+    Header found{};
+    struct stat status {};
+    const bool matches{
+        fstat(fd, &status) == 0 &&
+        static_cast<std::size_t>(status.st_size) == bytes &&
+        pread(fd, &found, sizeof(found), 0) == sizeof(found) &&
+        std::memcmp(&found, &expected, sizeof(found)) == 0};
+    // a cache of another size or capacity starts over, empty slots are 0
+    if (!matches &&
+        (ftruncate(fd, 0) != 0 ||
+         ftruncate(fd, static_cast<off_t>(bytes)) != 0 ||
+         pwrite(fd, &expected, sizeof(expected), 0) != sizeof(expected))) {
+      close(fd);
+      throw std::runtime_error("unable to make the solution cache " + path);
+    }
+  }
+  auto *pMap{
+      mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+  if (pMap == MAP_FAILED) {
+    close(fd);
+    throw std::runtime_error("unable to map the solution cache " + path);
+  }
+  pMapped = static_cast<std::uint8_t *>(pMap);
+  mappedBytes = bytes;
+}
+
+SolutionCache::~SolutionCache() {
+  munmap(pMapped, mappedBytes);
+  close(fd);
+}
+
+std::string SolutionCache::DefaultPath(std::size_t size) {
+  std::string directory{};
+  if (const auto *cacheHome{std::getenv("XDG_CACHE_HOME")};
+      cacheHome && *cacheHome) {
+    directory = cacheHome;
+  } else if (const auto *home{std::getenv("HOME")}; home && *home) {
+    directory = std::string(home) + "/.cache";
+  } else {
+    directory = "/tmp";
+  }
+  return directory + "/shelldoku/solutions" + std::to_string(size) +
+         ".cache";
+}
+
+SolutionCache::Entry
+SolutionCache::Find(sudokuCanonical::Fingerprint fingerprint,
+                    std::span<std::uint8_t> solution) {
+  std::lock_guard lock{mutex};
+  FileLock fileLock{fd};
+  auto *pSlot{SlotOf(fingerprint)};
+  if (!pSlot) {
+    return Entry::Missing;
+  }
+  pSlot[ReferencedOffset] = 1;
+  const auto entry{static_cast<Entry>(pSlot[EntryOffset])};
+  if (entry == Entry::Solved) {
+    const auto *packed{pSlot + PackedOffset};
+    const auto mask{(1u << cellBits) - 1};
+    for (std::size_t i{}; i < solution.size(); i++) {
+      const auto bit{i * cellBits};
+      // a cell spans 2 bytes at most
+      const auto bits{static_cast<unsigned int>(packed[bit / 8]) |
+                      static_cast<unsigned int>(packed[bit / 8 + 1]) << 8};
+      solution[i] = static_cast<std::uint8_t>((bits >> (bit % 8) & mask) + 1);
+    }
+  }
+  return entry;
+}
+
+void SolutionCache::Store(sudokuCanonical::Fingerprint fingerprint,
+                          std::span<const std::uint8_t> solution) {
+  Keep(fingerprint, Entry::Solved, solution);
+}
+
+void SolutionCache::StoreUnsolvable(sudokuCanonical::Fingerprint fingerprint) {
+  Keep(fingerprint, Entry::Unsolvable, {});
+}
+
+std::uint8_t *SolutionCache::SlotOf(sudokuCanonical::Fingerprint fingerprint) {
+  const auto bucketBytes{BucketHeaderBytes + BucketSlots * slotBytes};
+  auto *pBucket{pMapped + HeaderBytes +
+                (fingerprint.high & (buckets - 1)) * bucketBytes};
+  for (std::size_t i{}; i < BucketSlots; i++) {
+    auto *pSlot{pBucket + BucketHeaderBytes + i * slotBytes};
+    if (pSlot[EntryOffset] != static_cast<std::uint8_t>(Entry::Missing) &&
+        std::memcmp(pSlot, &fingerprint, sizeof(fingerprint)) == 0) {
+      return pSlot;
+    }
+  }
+  return nullptr;
+}
+
+std::uint8_t *
+SolutionCache::FreeSlotOf(sudokuCanonical::Fingerprint fingerprint) {
+  const auto bucketBytes{BucketHeaderBytes + BucketSlots * slotBytes};
+  auto *pBucket{pMapped + HeaderBytes +
+                (fingerprint.high & (buckets - 1)) * bucketBytes};
+  for (std::size_t i{}; i < BucketSlots; i++) {
+    auto *pSlot{pBucket + BucketHeaderBytes + i * slotBytes};
+    if (pSlot[EntryOffset] == static_cast<std::uint8_t>(Entry::Missing)) {
+      return pSlot;
+    }
+  }
+  // clock: referenced slots get a second chance, the hand passes each once
+  auto &hand{pBucket[0]};
+  while (true) {
+    auto *pSlot{pBucket + BucketHeaderBytes + hand % BucketSlots * slotBytes};
+    hand = static_cast<std::uint8_t>((hand + 1) % BucketSlots);
+    if (!pSlot[ReferencedOffset]) {
+      return pSlot;
+    }
+    pSlot[ReferencedOffset] = 0;
+  }
+}
+
+void SolutionCache::Keep(sudokuCanonical::Fingerprint fingerprint,
+                         Entry entry, std::span<const std::uint8_t> solution) {
+  std::lock_guard lock{mutex};
+  FileLock fileLock{fd};
+  auto *pSlot{SlotOf(fingerprint)};
+  if (!pSlot) {
+    pSlot = FreeSlotOf(fingerprint);
+  }
+  std::memset(pSlot, 0, slotBytes);
+  std::memcpy(pSlot, &fingerprint, sizeof(fingerprint));
+  pSlot[EntryOffset] = static_cast<std::uint8_t>(entry);
+  pSlot[ReferencedOffset] = 1;
+  auto *packed{pSlot + PackedOffset};
+  for (std::size_t i{}; i < solution.size(); i++) {
+    const auto bit{i * cellBits};
+    const auto bits{static_cast<unsigned int>(solution[i] - 1) << (bit % 8)};
+    packed[bit / 8] |= static_cast<std::uint8_t>(bits);
+    packed[bit / 8 + 1] |= static_cast<std::uint8_t>(bits >> 8);
+  }
+}
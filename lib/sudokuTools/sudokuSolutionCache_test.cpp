@@ -0,0 +1,156 @@
+#include "sudokuCanonical.h"
+#include "sudokuGenerator.h"
+#include "sudokuHelpers.h"
+#include "sudokuSolutionCache.h"
+#include "sudokuSolver.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Entries of the cache file survive reopening it, a full bucket evicts the
+// entries its clock hand finds unused, and a solver finds the solution of a
+// sudoku for every symmetric copy of it
+
+// symmetric copies solved per sudoku
+static constexpr int Copies{10};
+
+// Returns a cache file path of this process in the temp directory
+static std::string TempPath(const char *name) {
+  return (std::filesystem::temp_directory_path() /
+          ("shelldoku_" + std::string{name} + "_" +
+           std::to_string(getpid()) + ".cache"))
+      .string();
+}
+
+// Returns a 4x4 solution in labels, a different one per seed
+static std::array<std::uint8_t, 16> SolutionOf(unsigned int seed) {
+  std::array<std::uint8_t, 16> solution{};
+  for (std::size_t i{}; i < solution.size(); i++) {
+    solution[i] = static_cast<std::uint8_t>((i + i / 4 + seed) % 4 + 1);
+  }
+  return solution;
+}
+
+// Returns true if the cache holds the solution of the seed for the key
+static bool Holds(SolutionCache &cache, std::uint64_t key) {
+  std::array<std::uint8_t, 16> found{};
+  return cache.Find({0, key}, found) == SolutionCache::Entry::Solved &&
+         found == SolutionOf(static_cast<unsigned int>(key));
+}
+
+// Stores, finds and reopens entries of a 4x4 cache of a single bucket
+static bool ExpectRoundTrip(const std::string &path) {
+  bool passed{true};
+  {
+    SolutionCache cache{path, 4, 8};
+    cache.Store({0, 1}, SolutionOf(1));
+    cache.StoreUnsolvable({0, 2});
+    std::array<std::uint8_t, 16> found{};
+    passed &= Holds(cache, 1);
+    passed &= cache.Find({0, 2}, found) == SolutionCache::Entry::Unsolvable;
+    passed &= cache.Find({0, 3}, found) == SolutionCache::Entry::Missing;
+  }
+  {
+    SolutionCache reopened{path, 4, 8};
+    passed &= Holds(reopened, 1);
+  }
+  {
+    // a cache of another capacity starts over
+    SolutionCache resized{path, 4, 64};
+    std::array<std::uint8_t, 16> found{};
+    passed &= resized.Find({0, 1}, found) == SolutionCache::Entry::Missing;
+  }
+  std::printf("round trip: %s\n", passed ? "kept" : "lost");
+  return passed;
+}
+
+// Fills the single bucket of a 4x4 cache and checks which entries go
+static bool ExpectClockEviction(const std::string &path) {
+  SolutionCache cache{path, 4, 8};
+  for (std::uint64_t key{}; key < 8; key++) {
+    cache.Store({0, key}, SolutionOf(static_cast<unsigned int>(key)));
+  }
+  // every entry is referenced, the hand clears them all and evicts 0
+  cache.Store({0, 8}, SolutionOf(8));
+  // 2 is used again, the hand evicts 1 and then passes 2 for 3
+  std::array<std::uint8_t, 16> found{};
+  static_cast<void>(cache.Find({0, 2}, found));
+  cache.Store({0, 9}, SolutionOf(9));
+  cache.Store({0, 10}, SolutionOf(10));
+
+  bool passed{true};
+  for (std::uint64_t key{}; key <= 10; key++) {
+    const bool evicted{key == 0 || key == 1 || key == 3};
+    passed &= Holds(cache, key) != evicted;
+  }
+  std::printf("clock eviction: %s\n", passed ? "as expected" : "wrong");
+  return passed;
+}
+
+// Solves a sudoku into the cache, then solves Copies symmetric copies of it.
+// Returns false if a copy searched or got a solution other than the search
+static bool ExpectCachedCopies(const std::string &path) {
+  Generator dug{9, 3, std::chrono::seconds{10}, GeneratorTypes::Shift};
+  dug.seed = 2024;
+  SudokuGenerator generator{};
+  if (generator.Generate(dug) != GenerateResult::Generated) {
+    std::printf("cached copies: generation failed\n");
+    return false;
+  }
+
+  SudokuSolver searching{};
+  SudokuSolver caching{};
+  caching.UseCache(std::make_shared<SolutionCache>(path, 9));
+  Solver solver{9, 3, SolverTypes::Bitstring};
+  solver.values = dug.values;
+  if (caching.Solve(solver) != SolveResult::Solved) {
+    std::printf("cached copies: solve failed\n");
+    return false;
+  }
+
+  Generator transformer{9, 3, std::chrono::seconds{10},
+                        GeneratorTypes::Transform};
+  transformer.seed = 2024;
+  transformer.transformSeeds.push_back(dug.values);
+  int missed{};
+  for (int i{}; i < Copies; i++) {
+    if (generator.Generate(transformer) != GenerateResult::Generated) {
+      std::printf("cached copies: transform failed\n");
+      return false;
+    }
+    Solver expected{9, 3, SolverTypes::Bitstring};
+    expected.values = transformer.values;
+    Solver cached{9, 3, SolverTypes::Bitstring};
+    cached.values = transformer.values;
+    // a cache hit doesn't search
+    if (searching.Solve(expected) != SolveResult::Solved ||
+        caching.Solve(cached) != SolveResult::Solved ||
+        caching.LastSearch().nodes != 0 || cached.values != expected.values) {
+      missed++;
+    }
+  }
+  std::printf("cached copies: %d of %d missed\n", missed, Copies);
+  return missed == 0;
+}
+
+int main() {
+  const auto path{TempPath("solutions4")};
+  const auto solverPath{TempPath("solutions9")};
+  bool passed{true};
+  passed &= ExpectRoundTrip(path);
+  std::filesystem::remove(path);
+  passed &= ExpectClockEviction(path);
+  passed &= ExpectCachedCopies(solverPath);
+  std::filesystem::remove(path);
+  std::filesystem::remove(solverPath);
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,20 +1,55 @@
 #include "sudokuSolver.h"
 #include "sudokuSolver_.h"
 
+#include "sudokuBitmasks.h"
+#include "sudokuCanonical.h"
+#include "sudokuGrid.h"
 #include "sudokuHelpers.h"
+#include "sudokuSolutionCache.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// nodes the canonical form of a cached sudoku may take, a few milliseconds
+static constexpr std::size_t CacheNodeBudget{std::size_t{1} << 12};
 
 //================
 // public library functions
 ///================
 
+SudokuSolver::SudokuSolver() {}
+
+SudokuSolver::~SudokuSolver() {}
+
 bool SudokuSolver::CanBeSolved(const Solver &solver) {
   if (solver.values.empty()) {
     Log::Debug("Empty sudoku can't be solved...");
     return false;
   }
-  return GetRequiredSolver(solver.solvertType)->CanBeSolved(solver);
+  if (CacheKeyOf(solver)) {
+    if (const auto entry{FindCached(nullptr)};
+        entry != SolutionCache::Entry::Missing) {
+      return entry == SolutionCache::Entry::Solved;
+    }
+    // a copy is solved, the solution goes into the cache
+    Solver copy{solver};
+    const auto result{Search(copy)};
+    Cache(result, copy.values);
+    return result == SolveResult::Solved;
+  }
+  auto &backend{StartSearch(solver)};
+  const bool solvable{backend.CanBeSolved(solver)};
+  EndSearch(backend);
+  return solvable;
 }
 
 bool SudokuSolver::CanBePlaced(const Solver &solver, ValueLocation location,
@@ -25,7 +60,7 @@ bool SudokuSolver::CanBePlaced(const Solver &solver, ValueLocation location,
   }
 
   return GetRequiredSolver(solver.solvertType)
-      ->CanBePlaced(solver, location, value);
+      .CanBePlaced(solver, location, value);
 }
 
 bool SudokuSolver::ValidateSudoku(const Solver &solver) const {
@@ -33,197 +68,492 @@ bool SudokuSolver::ValidateSudoku(const Solver &solver) const {
     Log::Debug("Solver can't validate empty sudoku...");
     return false;
   }
-  return GetRequiredSolver(solver.solvertType)->ValidateSudoku(solver);
+  return GetRequiredSolver(solver.solvertType).ValidateSudoku(solver);
+}
+
+bool SudokuSolver::ValidateSudoku(const Solver &solver,
+                                  std::vector<ValueConflict> &conflicts) const {
+  if (solver.values.empty()) {
+    Log::Debug("Solver can't validate empty sudoku...");
+    return false;
+  }
+  return GetRequiredSolver(solver.solvertType)
+      .ValidateSudoku(solver, &conflicts);
 }
 
-std::unique_ptr<SudokuSolver_>
+SudokuSolver_ &
 SudokuSolver::GetRequiredSolver(const SolverTypes solverType) const {
+  const auto typeIdx{static_cast<std::size_t>(solverType)};
+  if (typeIdx < solvers.size() && solvers[typeIdx]) {
+    return *solvers[typeIdx];
+  }
+
+  std::unique_ptr<SudokuSolver_> pSolver{};
   switch (solverType) {
   case SolverTypes::Bitstring:
-    return std::make_unique<SudokuSolver_bitmasks>();
+    pSolver = std::make_unique<SudokuSolver_bitmasks>();
+    break;
+  case SolverTypes::DancingLinks:
+    pSolver = std::make_unique<SudokuSolver_dancingLinks>();
+    break;
+  case SolverTypes::ConstraintPropagation:
+    pSolver = std::make_unique<SudokuSolver_propagation>();
+    break;
+  case SolverTypes::Bitboard:
+    pSolver = std::make_unique<SudokuSolver_bitboard>();
+    break;
   default:
   case SolverTypes::None:
-    break;
+    throw std::runtime_error("unsupported solver type");
   }
 
-  throw std::runtime_error("unsupported solver type");
+  solvers[typeIdx] = std::move(pSolver);
+  return *solvers[typeIdx];
 }
 
-bool SudokuSolver::Solve(Solver &solver) {
-  if (solver.values.empty()) {
-    Log::Debug("Solver solved empty sudoku...");
-    return true;
-  }
-  return GetRequiredSolver(solver.solvertType)->Solve(solver);
+SudokuSolver_ &SudokuSolver::StartSearch(const Solver &solver) {
+  auto &backend{GetRequiredSolver(solver.solvertType)};
+  backend.budget.Start(solver.stopToken, solver.nodeBudget);
+  return backend;
 }
 
-//================
-// private library functions
-///================
-
-bool SudokuSolver_::CanBeSolved(const Solver &solver) noexcept {
-  auto solverCopy = solver;
-  return Solve(solverCopy);
+void SudokuSolver::EndSearch(const SudokuSolver_ &backend) {
+  lastSearch = backend.budget.Stats();
 }
 
-bool SudokuSolver_bitmasks::Solve(Solver &solver) noexcept {
-  GenerateBitMasks(solver);
-
-  return Solve(solver, {0, 0});
+const SearchStats &SudokuSolver::LastSearch() const noexcept {
+  return lastSearch;
 }
 
-bool SudokuSolver_bitmasks::CanBePlaced(const Solver &solver,
-                                        ValueLocation location,
-                                        SudokuValue value) const noexcept {
-  if (!value.has_value() ||
-      !XYToSquareIndex(solver.size, solver.sectionSize, location).has_value() ||
-      !GeneratedBitMasks(solver) || location.first >= solver.size ||
-      location.second >= solver.size) {
-    return false;
+void SudokuSolver::Reset() {
+  for (auto &pSolver : solvers) {
+    if (pSolver) {
+      pSolver->Reset();
+    }
   }
+}
 
-  return !((bitMasksColumns[location.first] >> value.value()) & 1) &&
-         !((bitMasksRows[location.second] >> value.value()) & 1) &&
-         !((bitMasksSquares[XYToSquareIndex(solver.size, solver.sectionSize,
-                                            location)
-                                .value()] >>
-            value.value()) &
-           1);
+std::size_t SudokuSolver::CountSolutions(const Solver &solver,
+                                         std::size_t limit) {
+  if (solver.values.empty()) {
+    Log::Debug("Solver can't count solutions of an empty sudoku...");
+    return 0;
+  }
+  auto &backend{StartSearch(solver)};
+  const auto count{backend.CountSolutions(solver, limit)};
+  EndSearch(backend);
+  return count;
 }
 
-void SudokuSolver_bitmasks::PrepareSudoku(const Solver &solver) noexcept {
-  ClearBitMasks();
-  GenerateBitMasks(solver);
+SolveResult SudokuSolver::Solve(Solver &solver) {
+  if (solver.values.empty()) {
+    Log::Debug("Solver solved empty sudoku...");
+    return SolveResult::Solved;
+  }
+  const bool cacheable{CacheKeyOf(solver)};
+  if (cacheable) {
+    switch (FindCached(&solver.values)) {
+    case SolutionCache::Entry::Solved:
+      return SolveResult::Solved;
+    case SolutionCache::Entry::Unsolvable:
+      return SolveResult::Unsolvable;
+    case SolutionCache::Entry::Missing:
+    default:
+      break;
+    }
+  }
+  const auto result{Search(solver)};
+  if (cacheable) {
+    Cache(result, solver.values);
+  }
+  return result;
 }
 
-void SudokuSolver_bitmasks::GenerateBitMasks(const Solver &solver) {
-  ClearBitMasks();
+void SudokuSolver::UseCache(std::shared_ptr<SolutionCache> pCache_) {
+  pCache = std::move(pCache_);
+}
 
-  bitMasksRows.resize(solver.size);
-  bitMasksColumns.resize(solver.size);
-  bitMasksSquares.resize(solver.size);
+SolveResult SudokuSolver::Search(Solver &solver) {
+  auto &backend{StartSearch(solver)};
+  const bool solved{backend.Solve(solver)};
+  EndSearch(backend);
+  if (solved) {
+    return SolveResult::Solved;
+  }
+  switch (lastSearch.stop) {
+  case SearchStop::Cancelled:
+    return SolveResult::Cancelled;
+  case SearchStop::BudgetExceeded:
+    return SolveResult::BudgetExceeded;
+  case SearchStop::None:
+  default:
+    return SolveResult::Unsolvable;
+  }
+}
 
-  for (unsigned int r{}; r < solver.size; r++) {
-    for (unsigned int c{}; c < solver.size; c++) {
-      const auto v = solver.values.at(XYToSudokuPos(solver.size, {c, r}));
-      SetBitMasks(solver, {c, r}, v);
+// Returns the value of every label of the canonical form and the label of
+// every value. Values missing from the sudoku take the labels left in order,
+// any order solves the sudoku
+static void
+LabelsOf(const sudokuCanonical::Transform &transform, std::size_t size,
+         std::array<unsigned int, 65> &valueOf,
+         std::array<std::uint8_t, 65> &labelOf) noexcept {
+  labelOf.fill(0);
+  for (std::size_t label{1}; label <= size; label++) {
+    valueOf[label] = transform.valueOf[label];
+    if (valueOf[label]) {
+      labelOf[valueOf[label]] = static_cast<std::uint8_t>(label);
     }
   }
+  unsigned int missing{1};
+  for (std::size_t label{1}; label <= size; label++) {
+    if (valueOf[label]) {
+      continue;
+    }
+    while (labelOf[missing]) {
+      missing++;
+    }
+    valueOf[label] = missing;
+    labelOf[missing] = static_cast<std::uint8_t>(label);
+  }
 }
 
-void SudokuSolver_bitmasks::ClearBitMasks() {
-  bitMasksRows.clear();
-  bitMasksColumns.clear();
-  bitMasksSquares.clear();
+bool SudokuSolver::CacheKeyOf(const Solver &solver) {
+  if (!pCache || pCache->Size() != solver.size ||
+      solver.sectionSize * solver.sectionSize != solver.size ||
+      solver.values.size() != solver.size * solver.size ||
+      std::ranges::any_of(solver.values, [&solver](const auto &value) {
+        return value && *value > solver.size;
+      })) {
+    return false;
+  }
+  // more clues than holes propagate into a solution faster than their
+  // canonical form is found
+  const auto clues{static_cast<std::size_t>(std::ranges::count_if(
+      solver.values, [](const auto &value) { return value.has_value(); }))};
+  if (2 * clues > solver.values.size()) {
+    return false;
+  }
+  const auto nodeBudget{solver.nodeBudget
+                            ? std::min(solver.nodeBudget, CacheNodeBudget)
+                            : CacheNodeBudget};
+  const auto canonical{canonicalizer.Canonicalize(
+      solver.values, solver.size, solver.sectionSize, solver.stopToken,
+      nodeBudget)};
+  if (canonical.empty()) {
+    return false;
+  }
+  cacheKey = sudokuCanonical::FingerprintOf(canonical);
+  return true;
 }
 
-void SudokuSolver_bitmasks::SetBitMasks(const Solver &solver,
-                                        ValueLocation location,
-                                        SudokuValue value) noexcept {
-  if (!value.has_value() ||
-      !XYToSquareIndex(solver.size, solver.sectionSize, location).has_value() ||
-      !GeneratedBitMasks(solver) || location.first >= solver.size ||
-      location.second >= solver.size) {
-    return;
+SolutionCache::Entry
+SudokuSolver::FindCached(std::vector<SudokuValue> *pValues) {
+  cachedSolution.resize(pCache->Size() * pCache->Size());
+  const auto entry{pCache->Find(cacheKey, cachedSolution)};
+  if (entry != SolutionCache::Entry::Solved &&
+      entry != SolutionCache::Entry::Unsolvable) {
+    return SolutionCache::Entry::Missing;
   }
-
-  const auto v = (value ? value.value() : 0);
-
-  bitMasksColumns[location.first] |= 1 << v;
-  bitMasksRows[location.second] |= 1 << v;
-  bitMasksSquares[XYToSquareIndex(solver.size, solver.sectionSize, location)
-                      .value()] |= 1 << v;
+  // nothing was searched
+  lastSearch = {};
+  if (entry == SolutionCache::Entry::Solved && pValues) {
+    std::array<unsigned int, 65> valueOf{};
+    std::array<std::uint8_t, 65> labelOf{};
+    const auto &transform{canonicalizer.LastTransform()};
+    LabelsOf(transform, pCache->Size(), valueOf, labelOf);
+    for (std::size_t i{}; i < cachedSolution.size(); i++) {
+      (*pValues)[transform.cellOf[i]] = valueOf[cachedSolution[i]];
+    }
+  }
+  return entry;
 }
 
-void SudokuSolver_bitmasks::ResetBitMasks(const Solver &solver,
-                                          ValueLocation location,
-                                          SudokuValue value) noexcept {
-  if (!XYToSquareIndex(solver.size, solver.sectionSize, location).has_value()) {
+void SudokuSolver::Cache(SolveResult result,
+                         const std::vector<SudokuValue> &solution) {
+  if (result == SolveResult::Unsolvable) {
+    pCache->StoreUnsolvable(cacheKey);
     return;
   }
-
-  if (!value.has_value()) {
+  // a stopped search says nothing about the sudoku
+  if (result != SolveResult::Solved) {
     return;
   }
-
-  bitMasksColumns[location.first] &= ~(1 << value.value());
-  bitMasksRows[location.second] &= ~(1 << value.value());
-  bitMasksSquares[XYToSquareIndex(solver.size, solver.sectionSize, location)
-                      .value()] &= ~(1 << value.value());
-}
-
-bool SudokuSolver_bitmasks::GeneratedBitMasks(
-    const Solver &solver) const noexcept {
-  return (!(bitMasksRows.empty() || bitMasksColumns.empty() ||
-            bitMasksSquares.empty())) &&
-         bitMasksRows.size() == solver.size &&
-         bitMasksColumns.size() == solver.size &&
-         bitMasksSquares.size() == solver.size;
+  std::array<unsigned int, 65> valueOf{};
+  std::array<std::uint8_t, 65> labelOf{};
+  const auto &transform{canonicalizer.LastTransform()};
+  LabelsOf(transform, pCache->Size(), valueOf, labelOf);
+  cachedSolution.resize(solution.size());
+  for (std::size_t i{}; i < cachedSolution.size(); i++) {
+    cachedSolution[i] = labelOf[solution[transform.cellOf[i]].value_or(0)];
+  }
+  pCache->Store(cacheKey, cachedSolution);
 }
 
-bool SudokuSolver_bitmasks::Solve(Solver &solver, ValueLocation location) {
-  if (location.first == solver.size - 1 && location.second == solver.size) {
-    return true;
+template <std::size_t Box>
+BatchReport SudokuSolver::SolveBatch(std::span<const Grid<Box>> puzzles,
+                                     std::span<Grid<Box>> solutions,
+                                     const BatchOptions &options) {
+  BatchReport report{};
+  if (solutions.size() < puzzles.size()) {
+    Log::Debug("Batch needs a solution for every puzzle...");
+    return report;
   }
 
-  if (location.second == solver.size) {
-    location.first++;
-    location.second = 0;
+  const std::size_t threads{std::max<std::size_t>(
+      options.threads ? options.threads : std::thread::hardware_concurrency(),
+      1)};
+  if (!pBatchPool || pBatchPool->Size() != threads) {
+    pBatchPool = std::make_unique<ThreadPool>(threads);
+  }
+  while (batchSolvers.size() < threads) {
+    batchSolvers.emplace_back(std::make_unique<SudokuSolver>());
   }
 
-  if (XYToSudokuPos(solver.size, location) >= solver.values.size()) {
-    return false;
+  // counters per worker, each on its own cache line
+  struct alignas(64) WorkerStats {
+    std::size_t solved{};
+    std::size_t unsolvable{};
+    std::size_t invalid{};
+    std::chrono::nanoseconds solveTime{};
+  };
+  std::vector<WorkerStats> stats(threads);
+  report.statuses.resize(puzzles.size());
+  std::atomic<std::size_t> next{};
+  const std::size_t chunkSize{std::max<std::size_t>(options.chunkSize, 1)};
+
+  const auto startT{std::chrono::steady_clock::now()};
+  for (std::size_t worker{}; worker < threads; worker++) {
+    pBatchPool->Submit([this, &puzzles, &solutions, &options, &report, &stats,
+                        &next, chunkSize, worker]() {
+      const auto workerStartT{std::chrono::steady_clock::now()};
+      auto &sudokuSolver{*batchSolvers[worker]};
+      auto &workerStats{stats[worker]};
+      Solver solver{Grid<Box>::Size, Box, options.solverType};
+      for (auto first{next.fetch_add(chunkSize, std::memory_order_relaxed)};
+           first < puzzles.size();
+           first = next.fetch_add(chunkSize, std::memory_order_relaxed)) {
+        const auto last{std::min(first + chunkSize, puzzles.size())};
+        for (auto idx{first}; idx < last; idx++) {
+          FromGrid(puzzles[idx], solver.values);
+          if (sudokuSolver.Solve(solver) == SolveResult::Solved &&
+              ToGrid(solver.values, solutions[idx])) {
+            report.statuses[idx] = BatchStatus::Solved;
+            workerStats.solved++;
+            continue;
+          }
+          solutions[idx] = puzzles[idx];
+          FromGrid(puzzles[idx], solver.values);
+          if (sudokuSolver.ValidateSudoku(solver)) {
+            report.statuses[idx] = BatchStatus::Unsolvable;
+            workerStats.unsolvable++;
+          } else {
+            report.statuses[idx] = BatchStatus::Invalid;
+            workerStats.invalid++;
+          }
+        }
+      }
+      workerStats.solveTime = std::chrono::steady_clock::now() - workerStartT;
+    });
+  }
+  pBatchPool->Wait();
+  report.wallTime = std::chrono::steady_clock::now() - startT;
+
+  for (const auto &workerStats : stats) {
+    report.solved += workerStats.solved;
+    report.unsolvable += workerStats.unsolvable;
+    report.invalid += workerStats.invalid;
+    report.solveTime += workerStats.solveTime;
   }
+  return report;
+}
+
+template BatchReport SudokuSolver::SolveBatch<2>(std::span<const Grid<2>>,
+                                                 std::span<Grid<2>>,
+                                                 const BatchOptions &);
+template BatchReport SudokuSolver::SolveBatch<3>(std::span<const Grid<3>>,
+                                                 std::span<Grid<3>>,
+                                                 const BatchOptions &);
+template BatchReport SudokuSolver::SolveBatch<4>(std::span<const Grid<4>>,
+                                                 std::span<Grid<4>>,
+                                                 const BatchOptions &);
+template BatchReport SudokuSolver::SolveBatch<5>(std::span<const Grid<5>>,
+                                                 std::span<Grid<5>>,
+                                                 const BatchOptions &);
 
-  if (solver.values[XYToSudokuPos(solver.size, location)]) {
-    return Solve(solver, {location.first, location.second + 1});
+//================
+// private library functions
+///================
+
+bool SudokuSolver_::CanBeSolved(const Solver &solver) noexcept {
+  return CountSolutions(solver, 1) > 0;
+}
+
+bool SudokuSolver_::CanBePlaced(const Solver &solver,
+                                ValueLocation location,
+                                SudokuValue value) const noexcept {
+  if (!value.has_value() || value.value() == 0 ||
+      value.value() > solver.size || location.first >= solver.size ||
+      location.second >= solver.size ||
+      solver.values.size() != solver.size * solver.size) {
+    return false;
   }
 
-  for (int value{1}; value <= solver.size; value++) {
-    if (CanBePlaced(solver, location, value)) {
-      solver.values[XYToSudokuPos(solver.size, location)] = {value};
-      SetBitMasks(solver, location, value);
-      if (Solve(solver, {location.first, location.second + 1})) {
-        return true;
-      }
-      ResetBitMasks(solver, location, value);
+  const auto squareIdx{
+      XYToSquareIndex(solver.size, solver.sectionSize, location).value()};
+  const auto firstOfSquare{
+      GetIndexOfSquare(solver.size, solver.sectionSize, squareIdx).value()};
+  for (std::size_t i{}; i < solver.size; i++) {
+    const auto inSquare{firstOfSquare + (i / solver.sectionSize) * solver.size +
+                        (i % solver.sectionSize)};
+    if (solver.values[XYToSudokuPos(solver.size, {i, location.second})] ==
+            value ||
+        solver.values[XYToSudokuPos(solver.size, {location.first, i})] ==
+            value ||
+        solver.values[inSquare] == value) {
+      return false;
     }
-    solver.values[XYToSudokuPos(solver.size, location)].reset();
   }
-
-  return false;
+  return true;
 }
 
-bool SudokuSolver_bitmasks::ValidateSudoku(const Solver &solver) noexcept {
-  ClearBitMasks();
-  GenerateBitMasks(solver);
-  auto solverCopy{solver};
+bool SudokuSolver_::ValidateSudoku(
+    const Solver &solver, std::vector<ValueConflict> *pConflicts) noexcept {
+  const auto size{solver.size};
+  if (solver.values.size() != size * size) {
+    return false;
+  }
+  // keeps its capacity between calls
+  firstSeen.assign(3 * size * size, NoCell);
 
+  bool valid{true};
   for (std::size_t idx{}; idx < solver.values.size(); idx++) {
-    const auto v = solver.values[idx];
-    if (!v.has_value()) {
+    if (!solver.values[idx].has_value()) {
       continue;
     }
-    // remove the current value
-    solverCopy.values[idx].reset();
-    ClearBitMasks();
-    GenerateBitMasks(solverCopy);
-    // try to place it
-    if (!CanBePlaced(solverCopy, SudokuPosToXY(solverCopy.size, idx), v)) {
-      ClearBitMasks();
+    const auto v{solver.values[idx].value()};
+    if (v == 0 || v > size) {
       return false;
     }
-    // set it again
-    solverCopy.values[idx] = v;
-    SetBitMasks(solver, SudokuPosToXY(solverCopy.size, idx), v);
+    const auto [x, y] = SudokuPosToXY(size, idx);
+    const std::size_t units[]{
+        y, size + x,
+        2 * size + SudokuPosSquareIndex(size, solver.sectionSize, idx).value()};
+    const auto reported{pConflicts ? pConflicts->size() : 0};
+    for (auto unit : units) {
+      auto &first{firstSeen[unit * size + v - 1]};
+      if (first == NoCell) {
+        first = idx;
+        continue;
+      }
+      if (!pConflicts) {
+        return false;
+      }
+      valid = false;
+      // cells sharing a line and a square are reported once
+      const ValueConflict conflict{first, idx};
+      if (std::find(pConflicts->begin() + reported, pConflicts->end(),
+                    conflict) == pConflicts->end()) {
+        pConflicts->emplace_back(conflict);
+      }
+    }
   }
+  return valid;
+}
 
-  ClearBitMasks();
-  return true;
+bool SudokuSolver_bitmasks::Solve(Solver &solver) noexcept {
+  return Run(solver, 1, &solver.values) > 0;
+}
+
+std::size_t SudokuSolver_bitmasks::CountSolutions(const Solver &solver,
+                                                  std::size_t limit) noexcept {
+  return Run(solver, limit, nullptr);
 }
 
-bool SudokuSolver_bitmasks::CanBeSolved(const Solver &solver) noexcept {
-  const auto r{SudokuSolver_::CanBeSolved(solver)};
-  ClearBitMasks();
-  return r;
+void SudokuSolver_bitmasks::PrepareSudoku(const Solver &) noexcept {}
+
+std::size_t
+SudokuSolver_bitmasks::Run(const Solver &solver, std::size_t limit,
+                           std::vector<SudokuValue> *pSolution) noexcept {
+  if (solver.threads > 1 && (!pPool || pPool->Size() != solver.threads)) {
+    pPool = std::make_unique<ThreadPool>(solver.threads);
+  }
+
+  std::size_t count{};
+  const bool supported{VisitGrid(
+      solver.sectionSize, [this, &solver, limit, pSolution, &count](auto box) {
+        constexpr auto Box{decltype(box)::value};
+        Grid<Box> grid{};
+        if (solver.size != Grid<Box>::Size || !ToGrid(solver.values, grid)) {
+          return;
+        }
+        if (solver.threads > 1) {
+          count = RunParallel(grid, limit);
+        } else {
+          BitmaskSearch<Box> search{};
+          count = search.CountSolutions(grid, limit, [this]() {
+            return budget.Spend(BitmaskSearch<Box>::StopCheckInterval);
+          });
+          budget.Count(search.Nodes() % BitmaskSearch<Box>::StopCheckInterval);
+        }
+        if (pSolution && count == limit) {
+          FromGrid(grid, *pSolution);
+        }
+      })};
+
+  if (!supported) {
+    Log::Debug("Bitmask solver has no grid for this section size...");
+  }
+  return count;
+}
+
+template <std::size_t Box>
+std::size_t SudokuSolver_bitmasks::RunParallel(Grid<Box> &grid,
+                                               std::size_t limit) {
+  if (!limit) {
+    return 0;
+  }
+  std::vector<Grid<Box>> tasks{grid};
+  // every child of the split is a search node
+  budget.Count(
+      BitmaskSearch<Box>::Split(tasks, pPool->Size() * TasksPerThread));
+
+  std::vector<std::size_t> counts(tasks.size());
+  std::atomic<std::size_t> total{};
+  // lowest task index with a solution
+  std::atomic<std::size_t> firstSolved{tasks.size()};
+  for (std::size_t i{}; i < tasks.size(); i++) {
+    pPool->Submit([this, &tasks, &counts, &total, &firstSolved, limit, i]() {
+      // a single solution has to be the first one in search order, so only
+      // the tasks after a solved task stop
+      const auto limitReached{[&total, &firstSolved, limit, i]() {
+        return limit == 1 ? firstSolved.load(std::memory_order_relaxed) < i
+                          : total.load(std::memory_order_relaxed) >= limit;
+      }};
+      if (budget.Spend(0) || limitReached()) {
+        return;
+      }
+      BitmaskSearch<Box> search{};
+      counts[i] = search.CountSolutions(
+          tasks[i], limit, [this, &limitReached]() {
+            return budget.Spend(BitmaskSearch<Box>::StopCheckInterval) ||
+                   limitReached();
+          });
+      budget.Count(search.Nodes() % BitmaskSearch<Box>::StopCheckInterval);
+      if (!counts[i]) {
+        return;
+      }
+      total += counts[i];
+      auto solved{firstSolved.load()};
+      while (i < solved && !firstSolved.compare_exchange_weak(solved, i)) {
+      }
+    });
+  }
+  pPool->Wait();
+
+  const auto count{std::min(total.load(), limit)};
+  if (limit == 1 && count) {
+    grid = tasks[firstSolved];
+  }
+  return count;
 }
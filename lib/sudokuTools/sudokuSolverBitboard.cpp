@@ -0,0 +1,120 @@
+#include "sudokuSolver.h"
+#include "sudokuSolver_.h"
+
+#include "sudokuBitboard.h"
+#include "sudokuBitboardKernel.h"
+#include "sudokuHelpers.h"
+#include <cstddef>
+#include <cstdint>
+
+// Bitboard solver for 9x9 sudokus.
+// The 81 cells of a board fit a single 128 bit register. The kernel is
+// compiled once per instruction set (scalar, SSE4.1, AVX2), the fastest one
+// the cpu supports is selected at runtime.
+
+namespace {
+// Portable fallback, a board is 2 64 bit words
+struct ScalarOps {
+  struct Board {
+    std::uint64_t lo;
+    std::uint64_t hi;
+  };
+
+  static Board Load(const bitboard::Mask &mask) noexcept {
+    return {mask.lo, mask.hi};
+  }
+  static Board Zero() noexcept { return {0, 0}; }
+  static Board And(Board a, Board b) noexcept {
+    return {a.lo & b.lo, a.hi & b.hi};
+  }
+  static Board AndNot(Board a, Board b) noexcept {
+    return {a.lo & ~b.lo, a.hi & ~b.hi};
+  }
+  static Board Or(Board a, Board b) noexcept {
+    return {a.lo | b.lo, a.hi | b.hi};
+  }
+  static bool IsZero(Board a) noexcept { return !(a.lo | a.hi); }
+  static int Popcount(Board a) noexcept {
+    return __builtin_popcountll(a.lo) + __builtin_popcountll(a.hi);
+  }
+  static std::size_t LowestCell(Board a) noexcept {
+    return a.lo ? __builtin_ctzll(a.lo) : 64 + __builtin_ctzll(a.hi);
+  }
+  static void ClearCell(Board *digits, Board cell) noexcept {
+    for (std::size_t digit{}; digit < bitboard::Size; digit++) {
+      digits[digit] = AndNot(digits[digit], cell);
+    }
+  }
+  static void Accumulate(const Board *digits, Board &once, Board &twice,
+                         Board &thrice) noexcept {
+    once = twice = thrice = Zero();
+    for (std::size_t digit{}; digit < bitboard::Size; digit++) {
+      thrice = Or(thrice, And(twice, digits[digit]));
+      twice = Or(twice, And(once, digits[digit]));
+      once = Or(once, digits[digit]);
+    }
+  }
+};
+} // namespace
+
+namespace bitboard {
+std::size_t RunScalar(const std::uint8_t *givens, std::uint8_t *solution,
+                      std::size_t limit, SearchBudget &budget) noexcept {
+  Kernel<ScalarOps> kernel;
+  return kernel.Run(givens, solution, limit, budget);
+}
+
+KernelFunction SelectKernel() noexcept {
+#if defined(SHELLDOKU_BITBOARD_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("popcnt")) {
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")) {
+      return RunAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+      return RunSse41;
+    }
+  }
+#endif
+  return RunScalar;
+}
+} // namespace bitboard
+
+SudokuSolver_bitboard::SudokuSolver_bitboard()
+    : kernel(bitboard::SelectKernel()) {}
+
+bool SudokuSolver_bitboard::Solve(Solver &solver) noexcept {
+  if (!Run(solver, 1)) {
+    return false;
+  }
+  for (std::size_t idx{}; idx < solution.size(); idx++) {
+    solver.values[idx] = solution[idx];
+  }
+  return true;
+}
+
+std::size_t SudokuSolver_bitboard::CountSolutions(const Solver &solver,
+                                                  std::size_t limit) noexcept {
+  return limit ? Run(solver, limit) : 0;
+}
+
+void SudokuSolver_bitboard::PrepareSudoku(const Solver &) noexcept {}
+
+std::size_t SudokuSolver_bitboard::Run(const Solver &solver,
+                                       std::size_t limit) noexcept {
+  if (solver.size != bitboard::Size ||
+      solver.sectionSize != bitboard::SectionSize ||
+      solver.values.size() != bitboard::Cells) {
+    Log::Debug("Bitboard solver only solves 9x9 sudokus...");
+    return 0;
+  }
+
+  for (std::size_t idx{}; idx < givens.size(); idx++) {
+    const auto v{solver.values[idx]};
+    if (v.has_value() && (v.value() == 0 || v.value() > bitboard::Size)) {
+      return 0;
+    }
+    givens[idx] = static_cast<std::uint8_t>(v.value_or(0));
+  }
+  return kernel(givens.data(), solution.data(), limit, budget);
+}
@@ -0,0 +1,231 @@
+#include "sudokuSolver.h"
+#include "sudokuSolver_.h"
+
+#include "sudokuHelpers.h"
+#include <vector>
+
+// https://arxiv.org/abs/cs/0011047
+// Every sudoku is an exact cover problem. Each matrix row is a possible
+// placement (cell, value), each matrix column is a constraint that has to be
+// satisfied exactly once:
+// cell:   every cell holds exactly one value
+// row:    every value appears once per row
+// column: every value appears once per column
+// square: every value appears once per square
+// For a 9x9 sudoku this results in 729 rows and 4 * 81 = 324 columns.
+
+namespace {
+// the amount of constraints every placement satisfies
+constexpr std::size_t ConstraintCount{4};
+} // namespace
+
+bool SudokuSolver_dancingLinks::Solve(Solver &solver) noexcept {
+  if (!Run(solver, 1)) {
+    return false;
+  }
+  for (auto row : solutionRows) {
+    solver.values[row / matrixSize] =
+        static_cast<unsigned int>(row % matrixSize) + 1;
+  }
+  return true;
+}
+
+std::size_t
+SudokuSolver_dancingLinks::CountSolutions(const Solver &solver,
+                                          std::size_t limit) noexcept {
+  return limit ? Run(solver, limit) : 0;
+}
+
+void SudokuSolver_dancingLinks::PrepareSudoku(const Solver &solver) noexcept {
+  BuildMatrix(solver);
+}
+
+void SudokuSolver_dancingLinks::Reset() noexcept {
+  // relink the matrix on the next run, the arena keeps its capacity
+  matrixSize = 0;
+  matrixSectionSize = 0;
+  selectedRows.clear();
+  solutionRows.clear();
+  solutionCount = 0;
+}
+
+void SudokuSolver_dancingLinks::BuildMatrix(const Solver &solver) {
+  if (matrixSize == solver.size && matrixSectionSize == solver.sectionSize &&
+      !nodes.empty()) {
+    return;
+  }
+  matrixSize = solver.size;
+  matrixSectionSize = solver.sectionSize;
+
+  const auto cells{matrixSize * matrixSize};
+  const auto columns{ConstraintCount * cells};
+  const auto rows{cells * matrixSize};
+
+  nodes.assign(1 + columns + rows * ConstraintCount, Node{});
+  columnSizes.assign(columns + 1, 0);
+  rowNodes.resize(rows);
+  selectedRows.reserve(cells);
+  solutionRows.reserve(cells);
+
+  // root and column headers form the header row
+  for (std::size_t header{}; header <= columns; header++) {
+    nodes[header].left = header == 0 ? columns : header - 1;
+    nodes[header].right = header == columns ? 0 : header + 1;
+    nodes[header].up = header;
+    nodes[header].down = header;
+    nodes[header].column = header;
+  }
+
+  std::size_t nodeIdx{columns + 1};
+  for (std::size_t idx{}; idx < cells; idx++) {
+    const auto [x, y] = SudokuPosToXY(matrixSize, idx);
+    const auto squareIdx{
+        SudokuPosSquareIndex(matrixSize, matrixSectionSize, idx).value()};
+    for (std::size_t v{}; v < matrixSize; v++) {
+      const auto row{idx * matrixSize + v};
+      // column headers are offset by 1 for the root
+      const std::size_t rowColumns[ConstraintCount]{
+          1 + idx, 1 + cells + y * matrixSize + v,
+          1 + 2 * cells + x * matrixSize + v,
+          1 + 3 * cells + squareIdx * matrixSize + v};
+
+      rowNodes[row] = nodeIdx;
+      for (std::size_t i{}; i < ConstraintCount; i++) {
+        auto &node{nodes[nodeIdx + i]};
+        const auto column{rowColumns[i]};
+        node.column = column;
+        node.row = row;
+        node.left = nodeIdx + (i + ConstraintCount - 1) % ConstraintCount;
+        node.right = nodeIdx + (i + 1) % ConstraintCount;
+        // append at the bottom of the column
+        node.up = nodes[column].up;
+        node.down = column;
+        nodes[nodes[column].up].down = nodeIdx + i;
+        nodes[column].up = nodeIdx + i;
+        columnSizes[column]++;
+      }
+      nodeIdx += ConstraintCount;
+    }
+  }
+}
+
+void SudokuSolver_dancingLinks::SelectRow(std::size_t row) noexcept {
+  const auto first{rowNodes[row]};
+  auto node{first};
+  do {
+    Cover(nodes[node].column);
+    node = nodes[node].right;
+  } while (node != first);
+}
+
+void SudokuSolver_dancingLinks::DeselectRow(std::size_t row) noexcept {
+  const auto first{rowNodes[row]};
+  auto node{nodes[first].left};
+  while (true) {
+    Uncover(nodes[node].column);
+    if (node == first) {
+      break;
+    }
+    node = nodes[node].left;
+  }
+}
+
+void SudokuSolver_dancingLinks::Cover(std::size_t column) noexcept {
+  nodes[nodes[column].right].left = nodes[column].left;
+  nodes[nodes[column].left].right = nodes[column].right;
+  for (auto i{nodes[column].down}; i != column; i = nodes[i].down) {
+    for (auto j{nodes[i].right}; j != i; j = nodes[j].right) {
+      nodes[nodes[j].down].up = nodes[j].up;
+      nodes[nodes[j].up].down = nodes[j].down;
+      columnSizes[nodes[j].column]--;
+    }
+  }
+}
+
+void SudokuSolver_dancingLinks::Uncover(std::size_t column) noexcept {
+  for (auto i{nodes[column].up}; i != column; i = nodes[i].up) {
+    for (auto j{nodes[i].left}; j != i; j = nodes[j].left) {
+      columnSizes[nodes[j].column]++;
+      nodes[nodes[j].down].up = j;
+      nodes[nodes[j].up].down = j;
+    }
+  }
+  nodes[nodes[column].right].left = column;
+  nodes[nodes[column].left].right = column;
+}
+
+bool SudokuSolver_dancingLinks::Search() noexcept {
+  if (nodes[0].right == 0) {
+    if (!solutionCount++) {
+      solutionRows = selectedRows;
+    }
+    return solutionCount >= solutionLimit;
+  }
+  // cancelled or out of budget, unwinds like a reached limit
+  if (SpendNode()) {
+    return true;
+  }
+
+  // branch on the column with the least rows left
+  auto column{nodes[0].right};
+  for (auto c{nodes[column].right}; c != 0; c = nodes[c].right) {
+    if (columnSizes[c] < columnSizes[column]) {
+      column = c;
+    }
+  }
+  if (columnSizes[column] == 0) {
+    return false;
+  }
+
+  bool done{false};
+  Cover(column);
+  for (auto i{nodes[column].down}; i != column && !done; i = nodes[i].down) {
+    selectedRows.push_back(nodes[i].row);
+    for (auto j{nodes[i].right}; j != i; j = nodes[j].right) {
+      Cover(nodes[j].column);
+    }
+    done = Search();
+    for (auto j{nodes[i].left}; j != i; j = nodes[j].left) {
+      Uncover(nodes[j].column);
+    }
+    selectedRows.pop_back();
+  }
+  Uncover(column);
+  return done;
+}
+
+std::size_t SudokuSolver_dancingLinks::Run(const Solver &solver,
+                                           std::size_t limit) {
+  if (solver.values.size() != solver.size * solver.size ||
+      !ValidateSudoku(solver)) {
+    return 0;
+  }
+  BuildMatrix(solver);
+
+  selectedRows.clear();
+  for (std::size_t idx{}; idx < solver.values.size(); idx++) {
+    if (solver.values[idx].has_value()) {
+      selectedRows.push_back(MatrixRow(idx, solver.values[idx].value()));
+      SelectRow(selectedRows.back());
+    }
+  }
+  const auto givensCount{selectedRows.size()};
+
+  solutionLimit = limit;
+  solutionCount = 0;
+  static_cast<void>(Search());
+  CountPendingNodes();
+
+  // leave the matrix untouched for the next run
+  for (auto givenIdx{givensCount}; givenIdx-- > 0;) {
+    DeselectRow(selectedRows[givenIdx]);
+  }
+  selectedRows.clear();
+  return solutionCount;
+}
+
+std::size_t
+SudokuSolver_dancingLinks::MatrixRow(std::size_t idx,
+                                     unsigned int value) const noexcept {
+  return idx * matrixSize + value - 1;
+}
@@ -0,0 +1,291 @@
+#include "sudokuSolver.h"
+#include "sudokuSolver_.h"
+
+#include "sudokuHelpers.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// https://norvig.com/sudoku.html
+// Every cell keeps a mask of the values that can still be placed on it.
+// Placing a value removes it from the candidates of all peers, after which:
+// naked single:  a cell with only 1 candidate left gets that value
+// hidden single: a value that fits only 1 cell of a unit goes on that cell
+// When nothing can be propagated anymore, the search branches on the cell
+// with the fewest candidates. Each search depth works on a copy of the state,
+// backtracking is returning to the previous depth.
+
+namespace {
+// the amount of units (row, column, square) every cell is part of
+constexpr std::size_t UnitsPerCell{3};
+
+[[nodiscard]] constexpr std::uint64_t FullMask(std::size_t size) noexcept {
+  return size >= 64 ? std::numeric_limits<std::uint64_t>::max()
+                    : (std::uint64_t{1} << size) - 1;
+}
+
+[[nodiscard]] constexpr unsigned int MaskToValue(std::uint64_t bit) noexcept {
+  return static_cast<unsigned int>(std::countr_zero(bit)) + 1;
+}
+} // namespace
+
+bool SudokuSolver_propagation::Solve(Solver &solver) noexcept {
+  if (!Run(solver, 1)) {
+    return false;
+  }
+  for (std::size_t idx{}; idx < solver.values.size(); idx++) {
+    solver.values[idx] = solution[idx];
+  }
+  return true;
+}
+
+std::size_t
+SudokuSolver_propagation::CountSolutions(const Solver &solver,
+                                         std::size_t limit) noexcept {
+  return limit ? Run(solver, limit) : 0;
+}
+
+std::size_t SudokuSolver_propagation::Run(const Solver &solver,
+                                          std::size_t limit) {
+  if (solver.values.size() != solver.size * solver.size || solver.size > 64) {
+    return 0;
+  }
+  BuildTables(solver);
+
+  auto &state{states.front()};
+  std::ranges::fill(state.candidates, FullMask(tableSize));
+  std::ranges::fill(state.values, 0);
+  state.filled = 0;
+  for (std::size_t idx{}; idx < solver.values.size(); idx++) {
+    if (!solver.values[idx].has_value()) {
+      continue;
+    }
+    const auto v{solver.values[idx].value()};
+    if (v == 0 || v > tableSize || !Assign(state, idx, v)) {
+      return 0;
+    }
+  }
+
+  solutionLimit = limit;
+  solutionCount = 0;
+  static_cast<void>(Search(0));
+  CountPendingNodes();
+  return solutionCount;
+}
+
+void SudokuSolver_propagation::PrepareSudoku(const Solver &solver) noexcept {
+  BuildTables(solver);
+}
+
+void SudokuSolver_propagation::Reset() noexcept {
+  // rebuild the tables on the next run, the states keep their capacity
+  tableSize = 0;
+  tableSectionSize = 0;
+  pending.clear();
+  solutionCount = 0;
+}
+
+void SudokuSolver_propagation::BuildTables(const Solver &solver) {
+  if (tableSize == solver.size && tableSectionSize == solver.sectionSize &&
+      !units.empty()) {
+    return;
+  }
+  tableSize = solver.size;
+  tableSectionSize = solver.sectionSize;
+  const auto cells{tableSize * tableSize};
+
+  // rows, then columns, then squares
+  units.resize(UnitsPerCell * tableSize * tableSize);
+  for (std::size_t unitIdx{}; unitIdx < tableSize; unitIdx++) {
+    const auto rowIndexes{GetAllIndexesOfRow(tableSize, unitIdx)};
+    const auto columnIndexes{GetAllIndexesOfColumn(tableSize, unitIdx)};
+    const auto squareIndexes{
+        GetAllIndexesOfSquare(tableSize, tableSectionSize, unitIdx)};
+    std::ranges::copy(rowIndexes, units.begin() + unitIdx * tableSize);
+    std::ranges::copy(columnIndexes,
+                      units.begin() + (tableSize + unitIdx) * tableSize);
+    std::ranges::copy(squareIndexes,
+                      units.begin() + (2 * tableSize + unitIdx) * tableSize);
+  }
+
+  cellUnits.resize(UnitsPerCell * cells);
+  std::vector<std::size_t> cellPeers{};
+  peers.clear();
+  for (std::size_t idx{}; idx < cells; idx++) {
+    const auto [x, y] = SudokuPosToXY(tableSize, idx);
+    cellUnits[idx * UnitsPerCell] = y;
+    cellUnits[idx * UnitsPerCell + 1] = tableSize + x;
+    cellUnits[idx * UnitsPerCell + 2] =
+        2 * tableSize +
+        SudokuPosSquareIndex(tableSize, tableSectionSize, idx).value();
+
+    cellPeers.clear();
+    for (std::size_t unit{}; unit < UnitsPerCell; unit++) {
+      const auto itUnit{units.begin() +
+                        cellUnits[idx * UnitsPerCell + unit] * tableSize};
+      std::copy_if(itUnit, itUnit + tableSize, std::back_inserter(cellPeers),
+                   [idx](auto peer) { return peer != idx; });
+    }
+    std::ranges::sort(cellPeers);
+    const auto duplicates{std::ranges::unique(cellPeers)};
+    cellPeers.erase(duplicates.begin(), duplicates.end());
+    // every cell of a square sudoku has the same amount of peers
+    peersPerCell = cellPeers.size();
+    peers.insert(peers.end(), cellPeers.begin(), cellPeers.end());
+  }
+
+  // every assignment fills at least 1 cell, the depth can't exceed the cells
+  states.resize(cells + 1);
+  for (auto &state : states) {
+    state.candidates.resize(cells);
+    state.values.resize(cells);
+  }
+  solution.resize(cells);
+  pending.reserve(cells);
+  dirtyUnits.resize(UnitsPerCell * tableSize);
+}
+
+bool SudokuSolver_propagation::Assign(State &state, std::size_t idx,
+                                      unsigned int value) noexcept {
+  const auto full{FullMask(tableSize)};
+  std::fill(dirtyUnits.begin(), dirtyUnits.end(), false);
+  pending.clear();
+  pending.emplace_back(idx, value);
+
+  while (!pending.empty()) {
+    // naked singles
+    while (!pending.empty()) {
+      const auto [cell, v] = pending.back();
+      pending.pop_back();
+      const std::uint64_t bit{std::uint64_t{1} << (v - 1)};
+      if (state.values[cell]) {
+        if (state.values[cell] != v) {
+          return false;
+        }
+        continue;
+      }
+      if (!(state.candidates[cell] & bit)) {
+        return false;
+      }
+
+      state.values[cell] = v;
+      state.candidates[cell] = bit;
+      state.filled++;
+      for (std::size_t unit{}; unit < UnitsPerCell; unit++) {
+        dirtyUnits[cellUnits[cell * UnitsPerCell + unit]] = true;
+      }
+
+      const auto itPeers{peers.begin() + cell * peersPerCell};
+      for (auto itPeer{itPeers}; itPeer != itPeers + peersPerCell; itPeer++) {
+        auto &candidates{state.candidates[*itPeer]};
+        if (!(candidates & bit)) {
+          continue;
+        }
+        // the peer already holds this value
+        if (state.values[*itPeer]) {
+          return false;
+        }
+        candidates &= ~bit;
+        if (!candidates) {
+          return false;
+        }
+        // the peer's other units may now hold a hidden single
+        for (std::size_t unit{}; unit < UnitsPerCell; unit++) {
+          dirtyUnits[cellUnits[*itPeer * UnitsPerCell + unit]] = true;
+        }
+        if (std::has_single_bit(candidates)) {
+          pending.emplace_back(*itPeer, MaskToValue(candidates));
+        }
+      }
+    }
+
+    // hidden singles in the units that changed
+    for (std::size_t unit{}; unit < dirtyUnits.size(); unit++) {
+      if (!dirtyUnits[unit]) {
+        continue;
+      }
+      dirtyUnits[unit] = false;
+
+      const auto itUnit{units.begin() + unit * tableSize};
+      std::uint64_t once{};
+      std::uint64_t twice{};
+      std::uint64_t placed{};
+      for (auto itCell{itUnit}; itCell != itUnit + tableSize; itCell++) {
+        const auto candidates{state.candidates[*itCell]};
+        if (state.values[*itCell]) {
+          placed |= candidates;
+        } else {
+          twice |= once & candidates;
+          once |= candidates;
+        }
+      }
+      // a value that can't go anywhere in this unit
+      if ((once | placed) != full) {
+        return false;
+      }
+
+      auto hidden{once & ~twice & ~placed};
+      while (hidden) {
+        const auto bit{hidden & (~hidden + 1)};
+        hidden &= hidden - 1;
+        const auto itCell{
+            std::find_if(itUnit, itUnit + tableSize, [&state, bit](auto cell) {
+              return !state.values[cell] && (state.candidates[cell] & bit);
+            })};
+        pending.emplace_back(*itCell, MaskToValue(bit));
+      }
+    }
+  }
+
+  return true;
+}
+
+bool SudokuSolver_propagation::Search(std::size_t depth) noexcept {
+  const auto &state{states[depth]};
+  if (state.filled == state.values.size()) {
+    if (!solutionCount++) {
+      solution = state.values;
+    }
+    return solutionCount >= solutionLimit;
+  }
+  // cancelled or out of budget, unwinds like a reached limit
+  if (SpendNode()) {
+    return true;
+  }
+
+  // minimum remaining values: branch on the cell with the fewest candidates
+  std::size_t branchIdx{};
+  int fewest{std::numeric_limits<int>::max()};
+  for (std::size_t idx{}; idx < state.values.size(); idx++) {
+    if (state.values[idx]) {
+      continue;
+    }
+    const auto count{std::popcount(state.candidates[idx])};
+    if (count < fewest) {
+      fewest = count;
+      branchIdx = idx;
+      // a filled cell has 1 candidate, an empty one at least 2
+      if (count == 2) {
+        break;
+      }
+    }
+  }
+
+  auto candidates{state.candidates[branchIdx]};
+  auto &next{states[depth + 1]};
+  while (candidates) {
+    const auto bit{candidates & (~candidates + 1)};
+    candidates &= candidates - 1;
+
+    next.candidates = state.candidates;
+    next.values = state.values;
+    next.filled = state.filled;
+    if (Assign(next, branchIdx, MaskToValue(bit)) && Search(depth + 1)) {
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,90 @@
+#include "sudokuThreadPool.h"
+
+#include <cstddef>
+#include <mutex>
+#include <stop_token>
+#include <utility>
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+  if (!threadCount) {
+    threadCount = 1;
+  }
+  workers.reserve(threadCount);
+  for (std::size_t i{}; i < threadCount; i++) {
+    workers.emplace_back(std::make_unique<Worker>());
+  }
+  threads.reserve(threadCount);
+  for (std::size_t i{}; i < threadCount; i++) {
+    threads.emplace_back(
+        [this, i](std::stop_token stopToken) { WorkerLoop(stopToken, i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  for (auto &thread : threads) {
+    thread.request_stop();
+  }
+  threads.clear();
+}
+
+void ThreadPool::Submit(Task task) {
+  pending++;
+  auto &worker{*workers[nextWorker++ % workers.size()]};
+  {
+    std::lock_guard lock{worker.mutex};
+    worker.tasks.emplace_back(std::move(task));
+  }
+  {
+    std::lock_guard lock{mutex};
+    queued++;
+  }
+  wake.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock lock{mutex};
+  done.wait(lock, [this]() { return pending == 0; });
+}
+
+void ThreadPool::WorkerLoop(std::stop_token stopToken, std::size_t index) {
+  while (!stopToken.stop_requested()) {
+    Task task{};
+    if (TryPop(index, task) || TrySteal(index, task)) {
+      queued--;
+      task();
+      if (pending.fetch_sub(1) == 1) {
+        std::lock_guard lock{mutex};
+        done.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock lock{mutex};
+    wake.wait(lock, stopToken, [this]() { return queued > 0; });
+  }
+}
+
+bool ThreadPool::TryPop(std::size_t index, Task &task) {
+  auto &worker{*workers[index]};
+  std::lock_guard lock{worker.mutex};
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::TrySteal(std::size_t index, Task &task) {
+  for (std::size_t i{1}; i < workers.size(); i++) {
+    auto &victim{*workers[(index + i) % workers.size()]};
+    std::lock_guard lock{victim.mutex};
+    if (victim.tasks.empty()) {
+      continue;
+    }
+    task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
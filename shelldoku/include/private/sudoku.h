@@ -2,9 +2,12 @@
 #pragma once
 #include "sudokuGenerator.h"
 #include "sudokuHelpers.h"
+#include "sudokuSolutionCache.h"
 #include "sudokuSolver.h"
 
 #include <cstddef>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace EVENT_ID {
@@ -29,9 +32,11 @@ public:
 
   // Returns copy of values
   [[nodiscard]] const std::vector<SudokuValue> GetValues() const;
+  // Returns the sudoku size (width and height)
+  [[nodiscard]] inline std::size_t Size() const { return size; }
   // Returns the sudoku section size
   [[nodiscard]] inline const std::size_t SectionSize() const {
-    return size / 3;
+    return SectionSizeOf(size);
   }
 
   // Tries to place a value on a location
@@ -41,12 +46,18 @@ public:
   [[nodiscard]] bool IsSolvable() noexcept;
   // Solves the sudoku
   void Solve();
+  // Solving and checking the sudoku use the cache
+  void UseSolutionCache(std::shared_ptr<SolutionCache> pCache);
   // Start for continuous solving with user input
   void Start();
   // Stop for continuous solving with user input, locks all values
   void Stop();
   // Returns true if the sudoku is solved
   [[nodiscard]] bool IsSolved() const noexcept;
+  // Returns every pair of locations sharing a row, column or square that hold
+  // the same value
+  [[nodiscard]] std::vector<std::pair<ValueLocation, ValueLocation>>
+  GetConflicts() const;
 
 private:
   // Sets values to Lockable values vector
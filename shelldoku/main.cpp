@@ -9,6 +9,8 @@
 #include "sudokuHelpers.h"
 #include "sudokuMovement.h"
 #include "sudokuParser.h"
+#include "sudokuPool.h"
+#include "sudokuSolutionCache.h"
 
 #include "sudokuGenerator.h"
 #include "sudokuSolver.h"
@@ -18,9 +20,12 @@
 #include <getopt.h>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <pthread.h>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 struct ArgOptions {
   unsigned int size{9};
@@ -50,8 +55,14 @@ int main(int argc, char *argv[]) {
   InputHandling::Input input{pEventQueue};
 
   Sudoku sudoku;
-  Solver solver{size, size / 3, SolverTypes::Bitstring};
-  if (options.generate) {
+  Solver solver{size, SectionSizeOf(size), SolverTypes::Bitstring};
+  // a running Shelldoku_generator --daemon has a sudoku ready
+  auto pooled{options.generate ? sudokuPool::Fetch(size)
+                               : std::optional<sudokuPool::PooledSudoku>{}};
+  if (pooled) {
+    Log::Debug("sudoku taken from the pool daemon");
+    sudoku = Sudoku(size, std::move(pooled->values));
+  } else if (options.generate) {
     sudoku = Sudoku(size);
     Generator settings{size, sudoku.SectionSize(), std::chrono::seconds(60),
                        GeneratorTypes::Shift};
@@ -62,6 +73,14 @@ int main(int argc, char *argv[]) {
     sudoku = Sudoku(size, pregeneratedValues);
   }
 
+  // sudokus solved before, also by other runs, are looked up
+  try {
+    sudoku.UseSolutionCache(std::make_shared<SolutionCache>(
+        SolutionCache::DefaultPath(size), size));
+  } catch (const std::runtime_error &) {
+    Log::Debug("solving without a solution cache");
+  }
+
   SudokuMovement positioner{static_cast<unsigned int>(sudoku.SectionSize())};
 
   // create input map
@@ -104,8 +123,8 @@ ArgOptions ParseArgs(int argc, char *argv[]) {
       "Quit with esc or Q\n"
       "-------------\n"
       "-h:\t\tprint this\n"
-      "-f <file>:\tuse file with pre generated sudokus, (default=generate "
-      "random sudoku)\n"
+      "-f <file>:\tuse file with pre generated sudokus, (default=take one "
+      "from Shelldoku_generator --daemon or generate a random sudoku)\n"
       "default file location: /etc/shelldoku_generator/sudoku.txt\n\n"
       "-------------\n"
       "Shelldoku_generator\n"
@@ -182,12 +201,26 @@ void CreateInputMap(InputHandling::Input &input, Sudoku &sudoku,
   input.AddKey("9", {KEY_9, std::make_shared<sudokuFunction>(sudokuFunction(EVENT_ID::SUDOKU_PLACE, placeOnPosition, 9))});
   input.AddKey("0", {KEY_0, std::make_shared<sudokuFunction>(sudokuFunction(EVENT_ID::SUDOKU_PLACE, placeOnPosition, 0))});
   
-  auto ready{[&sudoku, pEventQueue](){
+  auto ready{[&sudoku, &positioner, pEventQueue](){
     Dispatcher dis(pEventQueue);
     if(sudoku.IsSolved()) {
       dis.DispatchEvent(EVENT_ID::SUDOKU_SOLVED);
       sudoku.Stop();
     } else {
+      // show the player which cells clash, positions are 1 based (column, row)
+      std::string msg{};
+      for(const auto &[first, second] : sudoku.GetConflicts()) {
+        msg += "(";
+        msg += std::to_string(first.first + 1);
+        msg += ",";
+        msg += std::to_string(first.second + 1);
+        msg += ")=(";
+        msg += std::to_string(second.first + 1);
+        msg += ",";
+        msg += std::to_string(second.second + 1);
+        msg += ") ";
+      }
+      ShelldokuPrinter::PrintBelowField(msg.empty() ? "not filled in yet" : "conflicts: " + msg, sudoku.Size(), positioner.GetPosition());
       dis.DispatchEvent(EVENT_ID::SUDOKU_FAIL);
     }
   }};
@@ -3,6 +3,8 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <memory>
+#include <utility>
 #include <vector>
 
 // https://norvig.com/sudoku.html
@@ -80,7 +82,7 @@ Sudoku::~Sudoku() {}
 
 void Sudoku::GenerateSudoku(Generator &generator) {
   generator.values = GetValues();
-  if (!sudokuGenerator.Generate(generator)) {
+  if (sudokuGenerator.Generate(generator) != GenerateResult::Generated) {
     Log::Debug("Unable to generate");
   }
   SetValues(generator.values);
@@ -161,7 +163,7 @@ void Sudoku::Solve() {
   Solver solver{size, SectionSize(), SolverTypes::Bitstring};
   solver.values = GetValues();
   Log::Debug("trying to solve...");
-  if (sudokuSolver.Solve(solver)) {
+  if (sudokuSolver.Solve(solver) == SolveResult::Solved) {
     SetValues(solver.values);
     Log::Debug("solved");
   } else {
@@ -169,6 +171,10 @@ void Sudoku::Solve() {
   }
 }
 
+void Sudoku::UseSolutionCache(std::shared_ptr<SolutionCache> pCache) {
+  sudokuSolver.UseCache(std::move(pCache));
+}
+
 void Sudoku::Start() {}
 
 void Sudoku::Stop() {
@@ -178,3 +184,19 @@ void Sudoku::Stop() {
 }
 
 bool Sudoku::IsSolved() const noexcept { return IsSolved(values); }
+
+std::vector<std::pair<ValueLocation, ValueLocation>>
+Sudoku::GetConflicts() const {
+  Solver solver{size, SectionSize(), SolverTypes::Bitstring};
+  solver.values = GetValues();
+  std::vector<ValueConflict> conflicts{};
+  static_cast<void>(sudokuSolver.ValidateSudoku(solver, conflicts));
+
+  std::vector<std::pair<ValueLocation, ValueLocation>> locations{};
+  locations.reserve(conflicts.size());
+  for (const auto &[first, second] : conflicts) {
+    locations.emplace_back(SudokuPosToXY(size, first),
+                           SudokuPosToXY(size, second));
+  }
+  return locations;
+}
@@ -0,0 +1,53 @@
+#include "batchedFile.h"
+#include "sudokuParser.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+BatchedFile::BatchedFile(const std::string &file, std::size_t capacity_)
+    : fd(open(file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644)),
+      capacity(capacity_) {
+  if (fd < 0) {
+    throw std::runtime_error("unable to open " + file);
+  }
+  // a line never makes the buffer grow past a flush
+  buffer.reserve(capacity + 4096);
+}
+
+BatchedFile::~BatchedFile() {
+  try {
+    Flush();
+  } catch (const std::runtime_error &) {
+    // nothing left to report to from a destructor
+  }
+  close(fd);
+}
+
+void BatchedFile::Append(std::span<const SudokuValue> values,
+                         sudokuDifficulty::Difficulty difficulty) {
+  sudokuParser::AppendLine(buffer, values, difficulty);
+  if (buffer.size() >= capacity) {
+    Flush();
+  }
+}
+
+void BatchedFile::Flush() {
+  // a write can be cut short by a signal or a full pipe, write the rest
+  std::size_t written{};
+  while (written < buffer.size()) {
+    const auto n{write(fd, buffer.data() + written, buffer.size() - written)};
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // a retry writes only what didn't make it to the file
+      buffer.erase(0, written);
+      throw std::runtime_error("unable to write the sudokus");
+    }
+    written += static_cast<std::size_t>(n);
+  }
+  buffer.clear();
+}
@@ -0,0 +1,403 @@
+#include "generationPipeline.h"
+#include "batchedFile.h"
+#include "sudokuCanonical.h"
+#include "sudokuDifficulty.h"
+#include "sudokuGenerator.h"
+#include "sudokuHelpers.h"
+#include "sudokuParser.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <ios>
+#include <iomanip>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// values handed over between two stages at most
+static constexpr std::size_t QueueCapacity{64};
+
+static constexpr std::array Difficulties{sudokuDifficulty::Difficulty::easy,
+                                         sudokuDifficulty::Difficulty::normal,
+                                         sudokuDifficulty::Difficulty::hard};
+
+// Returns the index of the quota of the difficulty
+[[nodiscard]] static std::size_t
+QuotaIndexOf(sudokuDifficulty::Difficulty difficulty) noexcept {
+  return static_cast<std::size_t>(
+      std::ranges::find(Difficulties, difficulty) - Difficulties.begin());
+}
+
+// Yields while the wait is short, sleeps once it takes longer so a waiting
+// stage leaves the cpu to the others
+static void Backoff(unsigned int &spins) {
+  if (++spins < 64) {
+    std::this_thread::yield();
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+// Adds the time since start to the busy time of a stage
+template <typename Stats>
+static void AddBusy(Stats &stats,
+                    std::chrono::steady_clock::time_point start) noexcept {
+  stats.busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+}
+
+GenerationPipeline::GenerationPipeline(PipelineOptions options_)
+    : options(std::move(options_)),
+      useQuotas(std::ranges::any_of(options.quotas,
+                                    [](auto q) { return q != 0; })),
+      grids(QueueCapacity), dug(QueueCapacity), rated(QueueCapacity) {
+  if (!useQuotas) {
+    left.back() = options.count;
+  } else {
+    for (std::size_t i{}; i < options.quotas.size(); i++) {
+      left[i] = options.quotas[i];
+    }
+  }
+  producing.threads = std::max(options.producers, 1u);
+  digging.threads = std::max(options.diggers, 1u);
+  rating.threads = std::max(options.raters, 1u);
+  writing.threads = 1;
+}
+
+std::size_t GenerationPipeline::Run() {
+  const auto startT{std::chrono::steady_clock::now()};
+  if (std::ranges::all_of(left, [](const auto &l) { return l == 0; })) {
+    return 0;
+  }
+  if (options.unique) {
+    LoadFingerprints();
+  }
+  // opened before the threads start, a file that can't be opened throws here
+  BatchedFile file{options.file};
+  // a stage counts as running before its threads start, the next stage can't
+  // mistake a slow start for the end
+  producing.running = producing.threads;
+  digging.running = digging.threads;
+  rating.running = rating.threads;
+  writing.running = writing.threads;
+
+  std::vector<std::thread> threads{};
+  for (unsigned int i{}; i < producing.threads; i++) {
+    threads.emplace_back([this, i]() { Produce(i); });
+  }
+  for (unsigned int i{}; i < digging.threads; i++) {
+    threads.emplace_back([this, i]() { Dig(i); });
+  }
+  for (unsigned int i{}; i < rating.threads; i++) {
+    threads.emplace_back([this]() { Rate(); });
+  }
+  threads.emplace_back([this, &file]() { Write(file); });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  runTime = std::chrono::steady_clock::now() - startT;
+  if (writeError) {
+    std::rethrow_exception(writeError);
+  }
+  return writing.items;
+}
+
+void GenerationPipeline::PrintSummary(std::ostream &os) const {
+  const auto seconds{std::chrono::duration<double>(runTime).count()};
+  os << "generation took " << std::fixed << std::setprecision(2) << seconds
+     << " seconds\n";
+  os << std::left << std::setw(12) << "stage" << std::right << std::setw(8)
+     << "threads" << std::setw(10) << "sudokus" << std::setw(12)
+     << "per second" << std::setw(8) << "busy" << "\n";
+  const auto printStage{[&os, seconds](const char *name,
+                                       const StageStats &stats) {
+    const auto busy{static_cast<double>(stats.busyNs.load()) / 1e9};
+    const auto items{stats.items.load()};
+    os << std::left << std::setw(12) << name << std::right << std::setw(8)
+       << stats.threads << std::setw(10) << items << std::setw(12)
+       << std::setprecision(1) << (seconds > 0 ? items / seconds : 0.0)
+       << std::setw(7) << std::setprecision(0)
+       << (seconds > 0 ? 100 * busy / (seconds * stats.threads) : 0.0)
+       << "%\n";
+  }};
+  printStage("grids", producing);
+  printStage("holes", digging);
+  printStage("rating", rating);
+  printStage("writing", writing);
+
+  os << std::left << std::setw(12) << "queue" << std::right << std::setw(10)
+     << "capacity" << std::setw(11) << "max depth" << std::setw(15)
+     << "average depth" << "\n";
+  const auto printQueue{[&os](const char *name, const auto &queue) {
+    os << std::left << std::setw(12) << name << std::right << std::setw(10)
+       << queue.Capacity() << std::setw(11) << queue.MaxDepth()
+       << std::setw(15) << std::setprecision(1) << queue.AverageDepth()
+       << "\n";
+  }};
+  printQueue("grids", grids);
+  printQueue("dug", dug);
+  printQueue("rated", rated);
+  if (options.unique) {
+    os << "duplicates dropped: " << duplicates.load() << ", "
+       << seen.Size() << " sudokus known, " << unchecked.load()
+       << " not checked\n";
+  }
+  os.unsetf(std::ios_base::floatfield);
+  os << std::setprecision(6);
+}
+
+void GenerationPipeline::Produce(unsigned int threadIdx) {
+  SudokuGenerator sudokuGenerator{};
+  Generator generator{options.size, SectionSizeOf(options.size),
+                      options.maxGenerationTime, GeneratorTypes::Shift};
+  generator.seed = SeedOf(0, threadIdx);
+  const auto stopToken{stopSource.get_token()};
+  // digging in transform mode needs a few grids only
+  while (!stopToken.stop_requested() && digging.running) {
+    const auto startT{std::chrono::steady_clock::now()};
+    if (!sudokuGenerator.GenerateGrid(generator)) {
+      continue;
+    }
+    auto grid{generator.values};
+    AddBusy(producing, startT);
+    if (!Push(grids, grid, true)) {
+      break;
+    }
+    producing.items++;
+  }
+  producing.running--;
+}
+
+void GenerationPipeline::Dig(unsigned int threadIdx) {
+  SudokuGenerator sudokuGenerator{};
+  const auto sectionSize{SectionSizeOf(options.size)};
+  // pokes holes in the grids of the producers
+  Generator digger{options.size, sectionSize, options.maxGenerationTime,
+                   GeneratorTypes::None};
+  digger.targetClues = options.clues;
+  digger.digOrder = options.digOrder;
+  digger.minimal = options.minimal;
+  digger.seed = SeedOf(producing.threads, threadIdx);
+  digger.stopToken = stopSource.get_token();
+  // transform mode: the dug sudokus are the seeds of the transforms
+  Generator transformer{options.size, sectionSize, options.maxGenerationTime,
+                        GeneratorTypes::Transform};
+  transformer.seed = digger.seed;
+
+  while (!digger.stopToken.stop_requested()) {
+    const bool transforming{options.transformSeeds &&
+                            transformer.transformSeeds.size() >=
+                                options.transformSeeds};
+    if (!transforming && !Pop(grids, digger.values, producing)) {
+      break;
+    }
+    const auto startT{std::chrono::steady_clock::now()};
+    auto &generator{transforming ? transformer : digger};
+    // the digger steers towards the difficulty needed most
+    const auto difficulty{NextDifficulty()};
+    if (useQuotas && !difficulty) {
+      break;
+    }
+    digger.targetDifficulty = difficulty;
+    const auto result{sudokuGenerator.Generate(generator)};
+    if (result == GenerateResult::Cancelled) {
+      break;
+    }
+    if (result != GenerateResult::Generated) {
+      // a difficulty the settings can't make leaves the others to dig
+      if (!difficulty) {
+        break;
+      }
+      failed[QuotaIndexOf(*difficulty)] = true;
+      continue;
+    }
+    if (difficulty) {
+      failed[QuotaIndexOf(*difficulty)] = false;
+    }
+    if (!transforming && options.transformSeeds) {
+      transformer.transformSeeds.push_back(digger.values);
+    }
+    Sudoku sudoku{generator.values, {}, sudokuGenerator.SolverCalls()};
+    AddBusy(digging, startT);
+    if (!Push(dug, sudoku, true)) {
+      break;
+    }
+    digging.items++;
+  }
+  // the last digger ends the generation, nothing is left to rate
+  if (!--digging.running) {
+    stopSource.request_stop();
+  }
+}
+
+void GenerationPipeline::Rate() {
+  sudokuDifficulty::DifficultyScore score{};
+  sudokuCanonical::Canonicalizer canonicalizer{};
+  const auto sectionSize{SectionSizeOf(options.size)};
+  const auto stopToken{stopSource.get_token()};
+  Sudoku sudoku{};
+  while (Pop(dug, sudoku, digging)) {
+    const auto startT{std::chrono::steady_clock::now()};
+    // (nearly) full big sudokus give up, they are kept unchecked
+    bool checked{!options.unique};
+    if (options.unique) {
+      const auto canonical{canonicalizer.Canonicalize(
+          sudoku.values, options.size, sectionSize, stopToken)};
+      checked = !canonical.empty();
+      if (checked && !IsNew(sudokuCanonical::FingerprintOf(canonical))) {
+        duplicates++;
+        AddBusy(rating, startT);
+        continue;
+      }
+    }
+    score.Reset(sudoku.values, options.size, SectionSizeOf(options.size));
+    sudoku.difficulty = score.GetDifficulty();
+    // a transform can be rated different than its seed
+    const auto claimed{Claim(sudoku.difficulty)};
+    AddBusy(rating, startT);
+    if (!claimed) {
+      continue;
+    }
+    if (!checked) {
+      unchecked++;
+    }
+    rating.items++;
+    // the writer takes every claimed sudoku, a full queue is only waited on
+    static_cast<void>(Push(rated, sudoku, false));
+  }
+  rating.running--;
+}
+
+void GenerationPipeline::Write(BatchedFile &file) {
+  Sudoku sudoku{};
+  while (Pop(rated, sudoku, rating)) {
+    // after a failed write the raters still hand over, nothing is written
+    if (writeError) {
+      continue;
+    }
+    const auto startT{std::chrono::steady_clock::now()};
+    try {
+      file.Append(sudoku.values, sudoku.difficulty);
+      writing.items++;
+    } catch (const std::runtime_error &) {
+      writeError = std::current_exception();
+      stopSource.request_stop();
+    }
+    AddBusy(writing, startT);
+  }
+  const auto startT{std::chrono::steady_clock::now()};
+  try {
+    file.Flush();
+  } catch (const std::runtime_error &) {
+    writeError = std::current_exception();
+  }
+  AddBusy(writing, startT);
+  writing.running--;
+}
+
+void GenerationPipeline::LoadFingerprints() {
+  std::ifstream file{options.file};
+  sudokuCanonical::Canonicalizer canonicalizer{};
+  std::vector<SudokuValue> values{};
+  std::string line{};
+  while (std::getline(file, line)) {
+    const auto dash{line.find('-')};
+    if (dash == std::string::npos) {
+      continue;
+    }
+    values.clear();
+    ParseFromString(values, line.substr(dash + 1));
+    // the file holds sudokus of every size
+    if (values.size() != options.size * options.size) {
+      continue;
+    }
+    const auto canonical{canonicalizer.Canonicalize(
+        values, options.size, SectionSizeOf(options.size))};
+    if (!canonical.empty()) {
+      seen.Insert(sudokuCanonical::FingerprintOf(canonical));
+    }
+  }
+}
+
+bool GenerationPipeline::IsNew(sudokuCanonical::Fingerprint fingerprint) {
+  std::lock_guard lock{seenMutex};
+  return seen.Insert(fingerprint);
+}
+
+std::optional<sudokuDifficulty::Difficulty>
+GenerationPipeline::NextDifficulty() const noexcept {
+  if (!useQuotas) {
+    return {};
+  }
+  std::optional<std::size_t> most{};
+  for (std::size_t i{}; i < Difficulties.size(); i++) {
+    if (left[i] && !failed[i] && (!most || left[i] > left[*most])) {
+      most = i;
+    }
+  }
+  if (!most) {
+    return {};
+  }
+  return Difficulties[*most];
+}
+
+bool GenerationPipeline::Claim(
+    sudokuDifficulty::Difficulty difficulty) noexcept {
+  auto &places{useQuotas ? left[QuotaIndexOf(difficulty)] : left.back()};
+  auto count{places.load()};
+  do {
+    if (!count) {
+      return false;
+    }
+  } while (!places.compare_exchange_weak(count, count - 1));
+  if (std::ranges::all_of(left, [](const auto &l) { return l == 0; })) {
+    stopSource.request_stop();
+  }
+  return true;
+}
+
+std::optional<std::uint64_t>
+GenerationPipeline::SeedOf(unsigned int stageOffset,
+                           unsigned int threadIdx) const noexcept {
+  if (!options.seed) {
+    return {};
+  }
+  return *options.seed + stageOffset + threadIdx;
+}
+
+template <typename T>
+bool GenerationPipeline::Push(BoundedQueue<T> &queue, T &value,
+                              bool untilStopped) {
+  unsigned int spins{};
+  while (!queue.TryPush(value)) {
+    if (untilStopped && stopSource.stop_requested()) {
+      return false;
+    }
+    Backoff(spins);
+  }
+  return true;
+}
+
+template <typename T>
+bool GenerationPipeline::Pop(BoundedQueue<T> &queue, T &value,
+                             const StageStats &before) {
+  unsigned int spins{};
+  while (!queue.TryPop(value)) {
+    // a value pushed right before the stage stopped is still taken
+    if (!before.running) {
+      return queue.TryPop(value);
+    }
+    Backoff(spins);
+  }
+  return true;
+}
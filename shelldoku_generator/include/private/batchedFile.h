@@ -0,0 +1,30 @@
+#pragma once
+#include "sudokuDifficulty.h"
+#include "sudokuHelpers.h"
+#include <cstddef>
+#include <span>
+#include <string>
+
+// Appends sudoku lines to a file through a memory buffer. The file is opened
+// once, a full buffer goes to the file with a single write.
+class BatchedFile final {
+public:
+  // Opens the file to append to, throws when it can't be opened
+  explicit BatchedFile(const std::string &file,
+                       std::size_t capacity_ = 1 << 20);
+  // Writes what is left in the buffer
+  ~BatchedFile();
+  BatchedFile(const BatchedFile &) = delete;
+  BatchedFile &operator=(const BatchedFile &) = delete;
+
+  void Append(std::span<const SudokuValue> values,
+              sudokuDifficulty::Difficulty difficulty);
+  // Writes the buffer to the file, throws when the write fails. The buffer
+  // keeps the bytes that weren't written
+  void Flush();
+
+private:
+  int fd{-1};
+  const std::size_t capacity;
+  std::string buffer{};
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded multi producer multi consumer queue without locks (Vyukov).
+// Every cell carries a sequence number telling whether it is free for the
+// producer of a position or filled for its consumer, a push or pop claims a
+// position with a single compare exchange. The capacity is rounded up to a
+// power of 2.
+template <typename T> class BoundedQueue final {
+public:
+  explicit BoundedQueue(std::size_t capacity_)
+      : capacity(std::bit_ceil(std::max<std::size_t>(capacity_, 2))),
+        cells(std::make_unique<Cell[]>(capacity)) {
+    for (std::size_t i{}; i < capacity; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  // Moves the value into the queue, returns false when the queue is full
+  [[nodiscard]] bool TryPush(T &value) {
+    auto pos{enqueuePos.load(std::memory_order_relaxed)};
+    for (;;) {
+      auto &cell{cells[pos & (capacity - 1)]};
+      const auto sequence{cell.sequence.load(std::memory_order_acquire)};
+      const auto diff{static_cast<std::ptrdiff_t>(sequence - pos)};
+      if (diff == 0) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          Sample(pos + 1);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Moves the oldest value out of the queue, returns false when it is empty
+  [[nodiscard]] bool TryPop(T &value) {
+    auto pos{dequeuePos.load(std::memory_order_relaxed)};
+    for (;;) {
+      auto &cell{cells[pos & (capacity - 1)]};
+      const auto sequence{cell.sequence.load(std::memory_order_acquire)};
+      const auto diff{static_cast<std::ptrdiff_t>(sequence - (pos + 1))};
+      if (diff == 0) {
+        if (dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          value = std::move(cell.value);
+          cell.sequence.store(pos + capacity, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  [[nodiscard]] std::size_t Capacity() const noexcept { return capacity; }
+  // Values in the queue, a snapshot while other threads push and pop
+  [[nodiscard]] std::size_t Size() const noexcept {
+    const auto popped{dequeuePos.load(std::memory_order_relaxed)};
+    const auto pushed{enqueuePos.load(std::memory_order_relaxed)};
+    return pushed > popped ? pushed - popped : 0;
+  }
+  // Largest and average amount of values in the queue right after a push
+  [[nodiscard]] std::size_t MaxDepth() const noexcept {
+    return maxDepth.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] double AverageDepth() const noexcept {
+    const auto pushes{enqueuePos.load(std::memory_order_relaxed)};
+    return pushes ? static_cast<double>(
+                        depthSum.load(std::memory_order_relaxed)) /
+                        static_cast<double>(pushes)
+                  : 0.0;
+  }
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> sequence{};
+    T value{};
+  };
+
+  void Sample(std::size_t pushed) noexcept {
+    const auto popped{dequeuePos.load(std::memory_order_relaxed)};
+    const auto depth{pushed > popped ? pushed - popped : 0};
+    depthSum.fetch_add(depth, std::memory_order_relaxed);
+    auto max{maxDepth.load(std::memory_order_relaxed)};
+    while (depth > max && !maxDepth.compare_exchange_weak(
+                              max, depth, std::memory_order_relaxed)) {
+    }
+  }
+
+  const std::size_t capacity;
+  std::unique_ptr<Cell[]> cells;
+  // producers and consumers claim positions on their own cache line
+  alignas(64) std::atomic<std::size_t> enqueuePos{};
+  alignas(64) std::atomic<std::size_t> dequeuePos{};
+  alignas(64) std::atomic<std::size_t> depthSum{};
+  std::atomic<std::size_t> maxDepth{};
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include "batchedFile.h"
+#include "boundedQueue.h"
+#include "sudokuCanonical.h"
+#include "sudokuDifficulty.h"
+#include "sudokuGenerator.h"
+#include "sudokuHelpers.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+struct PipelineOptions {
+  std::size_t size{9};
+  // threads per stage, there is a single writer
+  unsigned int producers{1};
+  unsigned int diggers{1};
+  unsigned int raters{1};
+  // time a digger may take for a single sudoku
+  std::chrono::seconds maxGenerationTime{5};
+  // sudokus of any difficulty, used without quotas
+  unsigned int count{1};
+  // sudokus per difficulty (easy, normal, hard)
+  std::array<unsigned int, 3> quotas{};
+  std::size_t clues{};
+  DigOrder digOrder{DigOrder::Random};
+  bool minimal{};
+  // thread n of a stage generates with seed + n, random without a seed
+  std::optional<std::uint64_t> seed{};
+  // seed sudokus dug per digger, the others are transforms of these
+  unsigned int transformSeeds{};
+  // the sudokus are appended to this file
+  std::string file{};
+  // drops sudokus that are the same up to symmetry as one in the file or one
+  // written before, transforms are the same as their seeds. Sudokus whose
+  // canonical form runs out of nodes (nearly full 16x16 and up) are kept
+  bool unique{true};
+};
+
+// Generates sudokus in stages that run at the same time:
+// producers make full grids, diggers poke holes in them, raters drop the
+// duplicates, rate the sudokus and fill the quotas, a single writer appends
+// them to the file in large blocks. Stages hand over through bounded queues
+// without locks, a stage only waits when its queue is full or empty.
+class GenerationPipeline final {
+public:
+  explicit GenerationPipeline(PipelineOptions options_);
+
+  // Runs the stages until the sudokus are written or the diggers give up,
+  // which they do once the last dig of every quota left failed. Returns the
+  // amount of sudokus written
+  std::size_t Run();
+  // Prints the throughput of every stage and the depth of every queue
+  void PrintSummary(std::ostream &os) const;
+
+private:
+  struct Sudoku {
+    std::vector<SudokuValue> values{};
+    sudokuDifficulty::Difficulty difficulty{};
+    std::size_t solverCalls{};
+  };
+  struct StageStats {
+    unsigned int threads{};
+    // running threads, the next stage stops once these are gone
+    std::atomic<unsigned int> running{};
+    std::atomic<std::size_t> items{};
+    // time spent working, waiting on the queues is not counted
+    std::atomic<std::int64_t> busyNs{};
+  };
+
+  void Produce(unsigned int threadIdx);
+  void Dig(unsigned int threadIdx);
+  void Rate();
+  void Write(BatchedFile &file);
+
+  // Adds the fingerprints of the sudokus of the size in the file
+  void LoadFingerprints();
+  // Returns false if a sudoku with the fingerprint was seen before
+  [[nodiscard]] bool IsNew(sudokuCanonical::Fingerprint fingerprint);
+
+  // Returns the difficulty with the most sudokus left whose last dig didn't
+  // fail, nothing without quotas or once every quota left failed
+  [[nodiscard]] std::optional<sudokuDifficulty::Difficulty>
+  NextDifficulty() const noexcept;
+  // Takes a place for a sudoku of the difficulty, stops the pipeline once
+  // every place is taken. Returns false if there is no place left
+  [[nodiscard]] bool Claim(sudokuDifficulty::Difficulty difficulty) noexcept;
+  // Returns the seed of a thread of a stage, nothing without a seed
+  [[nodiscard]] std::optional<std::uint64_t>
+  SeedOf(unsigned int stageOffset, unsigned int threadIdx) const noexcept;
+
+  // Waits until the value is pushed, gives up when the pipeline stops
+  template <typename T>
+  [[nodiscard]] bool Push(BoundedQueue<T> &queue, T &value,
+                          bool untilStopped);
+  // Waits until a value is popped, gives up once the stage before stopped
+  // and the queue is empty
+  template <typename T>
+  [[nodiscard]] bool Pop(BoundedQueue<T> &queue, T &value,
+                         const StageStats &before);
+
+  const PipelineOptions options;
+  // sudokus per difficulty, without quotas any difficulty will do
+  const bool useQuotas;
+  // sudokus left per difficulty (easy, normal, hard), any difficulty last
+  std::array<std::atomic<unsigned int>, 4> left{};
+  // difficulties whose last dig timed out or ran out of nodes, skipped while
+  // another quota is left
+  std::array<std::atomic<bool>, 3> failed{};
+  std::stop_source stopSource{};
+
+  StageStats producing{};
+  StageStats digging{};
+  StageStats rating{};
+  StageStats writing{};
+  BoundedQueue<std::vector<SudokuValue>> grids;
+  BoundedQueue<Sudoku> dug;
+  BoundedQueue<Sudoku> rated;
+  // fingerprints of the canonical forms of the sudokus seen
+  sudokuCanonical::FingerprintSet seen{};
+  std::mutex seenMutex{};
+  std::atomic<std::size_t> duplicates{};
+  // sudokus kept without a check, their canonical form took too long
+  std::atomic<std::size_t> unchecked{};
+  std::chrono::steady_clock::duration runTime{};
+  // first failed write, rethrown by Run
+  std::exception_ptr writeError{};
+};
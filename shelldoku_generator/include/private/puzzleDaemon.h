@@ -0,0 +1,85 @@
+#pragma once
+#include "batchedFile.h"
+#include "sudokuDifficulty.h"
+#include "sudokuGenerator.h"
+#include "sudokuHelpers.h"
+#include "sudokuPool.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+struct DaemonOptions {
+  std::size_t size{9};
+  // threads topping up the pools
+  unsigned int threads{1};
+  // sudokus kept ready per difficulty
+  std::size_t poolSize{32};
+  std::chrono::seconds maxGenerationTime{5};
+  std::size_t clues{};
+  DigOrder digOrder{DigOrder::Random};
+  bool minimal{};
+  std::optional<std::uint64_t> seed{};
+  // the pools start from and are kept in this sudoku file
+  std::string file{};
+  std::string socketPath{sudokuPool::SocketPath()};
+};
+
+// Keeps a pool of ready sudokus per difficulty and hands them out over a
+// local socket (see sudokuPool.h), generation runs while the pools are not
+// full. The pools start from the sudoku file and every sudoku that joins a
+// pool is appended to it, a sudoku leaves the file once it is served. The
+// pools survive a daemon that is killed.
+class PuzzleDaemon final {
+public:
+  explicit PuzzleDaemon(DaemonOptions options_);
+
+  // Serves until SIGINT or SIGTERM, throws when the socket can't be made
+  void Run();
+
+private:
+  using Pool = std::deque<std::vector<SudokuValue>>;
+
+  // Fills the pools with the sudokus of the pool size in the file
+  void LoadPools();
+  // Appends a sudoku joining the pool to the file. Call with the pools locked
+  void Persist(std::size_t poolIdx, const std::vector<SudokuValue> &values);
+  // Rewrites the file without the first line holding the served sudoku, the
+  // file is kept when the rewrite fails. Call with the pools locked
+  void Unpersist(std::size_t poolIdx, const std::vector<SudokuValue> &values);
+  void Generate(std::stop_token stopToken, unsigned int threadIdx);
+  void Serve(std::stop_token stopToken, int listenFd);
+  // Answers the requests of a connection until it closes
+  void Answer(int fd);
+  // Takes a sudoku of the difficulty, the fullest pool for any difficulty
+  [[nodiscard]] std::optional<sudokuPool::PooledSudoku>
+  Take(std::uint8_t difficulty);
+  // Returns true when every pool is full. Call with the pools locked
+  [[nodiscard]] bool PoolsFull() const noexcept;
+  // Returns the next pool that is not full, round robin. A pool is passed
+  // over once for every failed generation in a row it had, up to
+  // MaxBackOff. Call with the pools locked and not every pool full
+  [[nodiscard]] std::size_t NextPool() noexcept;
+
+  const DaemonOptions options;
+  // easy, normal and hard
+  std::array<Pool, 3> pools{};
+  // failed generations in a row and times passed over since, per pool
+  std::array<std::size_t, 3> failures{};
+  std::array<std::size_t, 3> passedOver{};
+  // the pool NextPool looks at first
+  std::size_t nextPool{};
+  // appends to the sudoku file, reopened when the file is replaced. Guarded
+  // by the pools mutex
+  std::optional<BatchedFile> file{};
+  mutable std::mutex poolsMutex{};
+  // a sudoku was taken, generation continues
+  std::condition_variable_any taken{};
+};
@@ -1,78 +1,112 @@
-#include "sudokuDifficulty.h"
+#include "generationPipeline.h"
+#include "puzzleDaemon.h"
 #include "sudokuGenerator.h"
 #include "sudokuHelpers.h"
-#include "sudokuParser.h"
+#include "sudokuPool.h"
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
-#include <fstream>
 #include <getopt.h>
-#include <ios>
 #include <iostream>
+#include <optional>
 #include <ostream>
 #include <string>
-#include <thread>
 #include <vector>
 
 static const std::string FILE_LOCATION = "shelldoku_generator/";
 static const std::string FILE_NAME = "sudoku";
 static const std::string FILE_EXTENSION = ".txt";
-static const std::string FILES_TMP_DIR =
-    std::filesystem::temp_directory_path().string() + "/" + FILE_LOCATION;
 static const std::string FILES_MAIN_DIR = "/etc/" + FILE_LOCATION;
 
 struct ArgOptions {
   unsigned int size{9};
+  // threads per pipeline stage
+  unsigned int producers{1};
   unsigned int threads{1};
+  unsigned int raters{1};
   std::chrono::seconds maxRunTime{5};
   unsigned int count{1};
+  // 0 generates minimal sudokus
+  std::size_t clues{};
+  // thread n of a stage generates with seed + n, random without a seed
+  std::optional<std::uint64_t> seed{};
+  // seed sudokus dug per digger in transform mode, 0 digs every sudoku
+  unsigned int transformSeeds{};
+  // sudokus per difficulty (easy, normal, hard), count is used without quotas
+  std::array<unsigned int, 3> quotas{};
+  DigOrder digOrder{DigOrder::Random};
+  bool minimal{};
+  // serves sudokus from pools of this size per difficulty instead
+  bool daemon{};
+  std::size_t poolSize{32};
+};
+
+// options only available as long option
+enum LongOption : int {
+  EasyQuota = 256,
+  NormalQuota,
+  HardQuota,
+  Producers,
+  Raters,
+  Daemon,
+  PoolSize
 };
 
 [[nodiscard]] ArgOptions ParseArgs(int argc, char *argv[]);
+[[nodiscard]] std::optional<DigOrder> ParseDigOrder(const std::string &name);
 
-std::string getTempFileLoc(std::thread::id threadId);
-void tempFilesToMainFile();
 
 int main(int argc, char *argv[]) {
   const auto options{ParseArgs(argc, argv)};
-  // thread lambda
-  auto generation{[options]() {
-    SudokuGenerator sudokuGenerator{};
-    Generator generator{options.size, options.size / 3, options.maxRunTime,
-                        GeneratorTypes::Shift};
-    unsigned int sudokuCount = options.count;
-    std::string fileLoc = getTempFileLoc(std::this_thread::get_id());
-    for (; sudokuCount; sudokuCount--) {
-      std::string msg{"generation "};
-      if (sudokuGenerator.Generate(generator)) {
-        msg += "complete";
-      } else {
-        msg += "failed";
-      }
-      msg += std::string(" - after ") +
-             std::to_string(sudokuGenerator.TotalTries()) + " tries";
-      std::cout << msg << std::endl;
-
-      const auto difficulty = sudokuDifficulty::CalculateDifficulty(
-          generator.values, generator.size, generator.sectionSize);
-      sudokuParser::ParseToFile(generator.values, difficulty, fileLoc);
-      sudokuGenerator.Reset();
-    }
-  }};
-
-  // threads
-  std::vector<std::thread> threads;
-  threads.resize(options.threads);
-
-  for (auto &thr : threads) {
-    thr = std::thread(generation);
+  const auto mainFile{FILES_MAIN_DIR + FILE_NAME + FILE_EXTENSION};
+  std::filesystem::create_directory(FILES_MAIN_DIR);
+  if (options.daemon) {
+    PuzzleDaemon daemon{DaemonOptions{.size = options.size,
+                                      .threads = options.threads,
+                                      .poolSize = options.poolSize,
+                                      .maxGenerationTime = options.maxRunTime,
+                                      .clues = options.clues,
+                                      .digOrder = options.digOrder,
+                                      .minimal = options.minimal,
+                                      .seed = options.seed,
+                                      .file = mainFile}};
+    std::cout << "serving sudokus on " << sudokuPool::SocketPath()
+              << std::endl;
+    daemon.Run();
+    return 0;
   }
+  GenerationPipeline pipeline{PipelineOptions{
+      .size = options.size,
+      .producers = options.producers,
+      .diggers = options.threads,
+      .raters = options.raters,
+      .maxGenerationTime = options.maxRunTime,
+      .count = options.count,
+      .quotas = options.quotas,
+      .clues = options.clues,
+      .digOrder = options.digOrder,
+      .minimal = options.minimal,
+      .seed = options.seed,
+      .transformSeeds = options.transformSeeds,
+      .file = mainFile,
+      .unique = options.transformSeeds == 0}};
+  const auto written{pipeline.Run()};
 
-  for (auto &thr : threads) {
-    thr.join();
+  const auto wanted{std::ranges::all_of(options.quotas,
+                                        [](auto q) { return q == 0; })
+                        ? options.count
+                        : options.quotas[0] + options.quotas[1] +
+                              options.quotas[2]};
+  if (written < wanted) {
+    std::cout << "generation failed - " << written << " of " << wanted
+              << " sudokus generated" << std::endl;
   }
-  // tmp thread files to single main file
-  tempFilesToMainFile();
+  pipeline.PrintSummary(std::cout);
+  std::cout << "generated in " << mainFile << "\n";
   // end
   std::cin.get();
 }
@@ -81,21 +115,56 @@ ArgOptions ParseArgs(int argc, char *argv[]) {
   const std::string HELP_MESSAGE{
       "Shelldoku_generator, generating and rating sudokus\n\n"
       "-h:\tprint this\n"
+      "-s:\tthe size of the sudokus: 4, 9, 16 or 25 (default: 9)\n"
       "-c:\tthe amount of sudokus to generate (default: 1)\n"
+      "-j:\tthe amount of threads poking holes (default: 1)\n"
+      "--producers, --raters:\tthe amount of threads making full grids and "
+      "rating sudokus (default: 1)\n"
       "-t:\tthe amount of time (seconds) to let the application run (default: "
-      "5 seconds)\n\n"
+      "5 seconds)\n"
+      "-n:\tthe amount of clues of a sudoku (default: as few as possible, "
+      "every sudoku has a single solution)\n"
+      "-r:\tthe seed of the generation, thread n uses seed + n (default: "
+      "random)\n"
+      "-x:\tdig this amount of sudokus per hole poking thread, the others are "
+      "transforms of these (default: 0, dig every sudoku). Without -x no "
+      "sudoku is written that is a transform of one in the sudoku file\n"
+      "-m:\tgenerate minimal sudokus, no clue can go without losing the "
+      "single solution\n"
+      "-o:\tthe order clues are removed in: random, rotational, mirror or "
+      "constrained (default: random)\n"
+      "--easy, --normal, --hard:\tthe amount of sudokus to generate of a "
+      "difficulty, replaces -c\n"
+      "--daemon:\tkeep pools of sudokus per difficulty ready and serve them "
+      "to Shelldoku until stopped, pooled sudokus stay in the sudoku file "
+      "until they are served\n"
+      "--pool:\tthe amount of sudokus per difficulty the daemon keeps ready "
+      "(default: 32)\n\n"
       "generated sudokus file in sudoku.txt"};
 
   int opt{};
   ArgOptions options{};
   static struct option long_options[] = {
-      {"help", no_argument, 0, 0},
-      {"size", required_argument, 0, 9},
-      {"threads", required_argument, 0, 1},
-      {"maxRunTime", required_argument, 0, 100},
-      {"count", required_argument, 0, 1}};
+      {"help", no_argument, 0, 'h'},
+      {"size", required_argument, 0, 's'},
+      {"threads", required_argument, 0, 'j'},
+      {"maxRunTime", required_argument, 0, 't'},
+      {"count", required_argument, 0, 'c'},
+      {"clues", required_argument, 0, 'n'},
+      {"seed", required_argument, 0, 'r'},
+      {"transform", required_argument, 0, 'x'},
+      {"minimal", no_argument, 0, 'm'},
+      {"order", required_argument, 0, 'o'},
+      {"easy", required_argument, 0, EasyQuota},
+      {"normal", required_argument, 0, NormalQuota},
+      {"hard", required_argument, 0, HardQuota},
+      {"producers", required_argument, 0, Producers},
+      {"raters", required_argument, 0, Raters},
+      {"daemon", no_argument, 0, Daemon},
+      {"pool", required_argument, 0, PoolSize},
+      {0, 0, 0, 0}};
   int option_index{};
-  while ((opt = getopt_long(argc, argv, "hs:j:t:c:", long_options,
+  while ((opt = getopt_long(argc, argv, "hs:j:t:c:n:r:x:mo:", long_options,
                             &option_index)) != -1) {
     switch (opt) {
     case 'h':
@@ -103,12 +172,16 @@ ArgOptions ParseArgs(int argc, char *argv[]) {
       exit(0);
       break;
     case 's':
-      // currently not used, all sudokus are 9x9
-      // options.size = std::stoi(optarg);
+      options.size = std::stoi(optarg);
+      // the solvers take sections of 2 up to 5
+      if (SectionSizeOf(options.size) < 2 || SectionSizeOf(options.size) > 5) {
+        std::cout << "Unsupported size, sudokus are 4, 9, 16 or 25 wide"
+                  << std::endl;
+        exit(1);
+      }
       break;
     case 'j':
-      // options.threads = std::stoi(optarg);
-      // std::cout << "Mutlithreaded does not work\n";
+      options.threads = std::stoi(optarg);
       break;
     case 't':
       options.maxRunTime = std::chrono::seconds(std::stoi(optarg));
@@ -116,37 +189,63 @@ ArgOptions ParseArgs(int argc, char *argv[]) {
     case 'c':
       options.count = std::stoi(optarg);
       break;
+    case 'n':
+      options.clues = std::stoul(optarg);
+      break;
+    case 'r':
+      options.seed = std::stoull(optarg);
+      break;
+    case 'x':
+      options.transformSeeds = std::stoi(optarg);
+      break;
+    case 'm':
+      options.minimal = true;
+      break;
+    case 'o':
+      if (const auto digOrder{ParseDigOrder(optarg)}) {
+        options.digOrder = *digOrder;
+      } else {
+        std::cout << "Unsupported order, clues are removed in a random, "
+                     "rotational, mirror or constrained order"
+                  << std::endl;
+        exit(1);
+      }
+      break;
+    case EasyQuota:
+    case NormalQuota:
+    case HardQuota:
+      options.quotas[opt - EasyQuota] = std::stoi(optarg);
+      break;
+    case Producers:
+      options.producers = std::stoi(optarg);
+      break;
+    case Raters:
+      options.raters = std::stoi(optarg);
+      break;
+    case Daemon:
+      options.daemon = true;
+      break;
+    case PoolSize:
+      options.poolSize = std::stoul(optarg);
+      break;
     }
   }
 
   return options;
 }
 
-std::string getTempFileLoc(std::thread::id threadId) {
-  std::stringstream ss;
-  ss << threadId;
-  ;
-  std::filesystem::create_directory(FILES_TMP_DIR);
-  return FILES_TMP_DIR + ss.str() + FILE_EXTENSION;
-}
-
-void tempFilesToMainFile() {
-  static const std::string MAIN_FILE_STR =
-      FILES_MAIN_DIR + FILE_NAME + FILE_EXTENSION;
-  std::filesystem::create_directory(FILES_MAIN_DIR);
-  std::ofstream mainFile;
-  mainFile.open(MAIN_FILE_STR, std::ios_base::app);
-
-  // concat main files by all tmp files
-  // access all tmp files by using filesystem iterator
-  for (const auto &tmpFileStr :
-       std::filesystem::directory_iterator(FILES_TMP_DIR)) {
-    std::ifstream tmpFile;
-    tmpFile.open(tmpFileStr.path());
-    mainFile << tmpFile.rdbuf();
-    tmpFile.close();
+std::optional<DigOrder> ParseDigOrder(const std::string &name) {
+  if (name == "random") {
+    return DigOrder::Random;
+  }
+  if (name == "rotational") {
+    return DigOrder::RotationalPairs;
+  }
+  if (name == "mirror") {
+    return DigOrder::MirrorPairs;
+  }
+  if (name == "constrained") {
+    return DigOrder::MostConstrained;
   }
-  // clean up tmp files
-  std::filesystem::remove_all(FILES_TMP_DIR);
-  std::cout << "generated in " << MAIN_FILE_STR << "\n";
+  return {};
 }
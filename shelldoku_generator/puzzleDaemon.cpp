@@ -0,0 +1,321 @@
+#include "puzzleDaemon.h"
+#include "batchedFile.h"
+#include "logger.h"
+#include "sudokuDifficulty.h"
+#include "sudokuGenerator.h"
+#include "sudokuHelpers.h"
+#include "sudokuPool.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <poll.h>
+#include <pthread.h>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+static constexpr std::array Difficulties{sudokuDifficulty::Difficulty::easy,
+                                         sudokuDifficulty::Difficulty::normal,
+                                         sudokuDifficulty::Difficulty::hard};
+// a pool failing to generate is passed over at most this many times in a row
+static constexpr std::size_t MaxBackOff{8};
+
+// Returns the pool of the difficulty byte of a request or a sudoku file line
+[[nodiscard]] static std::optional<std::size_t>
+PoolIndexOf(unsigned int difficulty) noexcept {
+  const auto it{std::ranges::find(Difficulties,
+                                  static_cast<sudokuDifficulty::Difficulty>(
+                                      difficulty))};
+  if (it == Difficulties.end()) {
+    return {};
+  }
+  return static_cast<std::size_t>(it - Difficulties.begin());
+}
+
+// Returns the pool and the sudoku of a sudoku file line, nothing for a line
+// of another size or difficulty
+[[nodiscard]] static std::optional<
+    std::pair<std::size_t, std::vector<SudokuValue>>>
+ParseLine(const std::string &line, std::size_t size) {
+  const auto dash{line.find('-')};
+  unsigned int difficulty{};
+  const auto [end, ec]{
+      std::from_chars(line.data(), line.data() + line.size(), difficulty)};
+  const auto poolIdx{PoolIndexOf(difficulty)};
+  if (ec != std::errc{} || dash == std::string::npos || !poolIdx) {
+    return {};
+  }
+  std::vector<SudokuValue> values{};
+  ParseFromString(values, line.substr(dash + 1));
+  if (values.size() != size * size) {
+    return {};
+  }
+  return std::pair{*poolIdx, std::move(values)};
+}
+
+// Returns a listening socket on the path, throws when another daemon listens
+// on it or it can't be made
+[[nodiscard]] static int Listen(const std::string &path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("socket path too long: " + path);
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  const auto *pAddress{reinterpret_cast<const sockaddr *>(&address)};
+
+  const auto fd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+  if (fd < 0) {
+    throw std::runtime_error("unable to make a socket");
+  }
+  // a socket nobody answers on is left by a daemon that didn't exit cleanly
+  if (connect(fd, pAddress, sizeof(address)) == 0) {
+    close(fd);
+    throw std::runtime_error("a daemon already listens on " + path);
+  }
+  unlink(path.c_str());
+  if (bind(fd, pAddress, sizeof(address)) != 0 || listen(fd, 16) != 0) {
+    close(fd);
+    throw std::runtime_error("unable to listen on " + path);
+  }
+  return fd;
+}
+
+PuzzleDaemon::PuzzleDaemon(DaemonOptions options_)
+    : options(std::move(options_)) {}
+
+void PuzzleDaemon::Run() {
+  // blocked before any thread starts, only sigwait takes these
+  sigset_t signals{};
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  const auto listenFd{Listen(options.socketPath)};
+  LoadPools();
+  file.emplace(options.file);
+  {
+    std::vector<std::jthread> threads{};
+    for (unsigned int i{}; i < std::max(options.threads, 1u); i++) {
+      threads.emplace_back(
+          [this, i](std::stop_token stopToken) { Generate(stopToken, i); });
+    }
+    threads.emplace_back([this, listenFd](std::stop_token stopToken) {
+      Serve(stopToken, listenFd);
+    });
+    int signal{};
+    sigwait(&signals, &signal);
+    Log::Debug("Puzzle daemon stopping...");
+    // the threads are stopped and joined here
+  }
+  close(listenFd);
+  unlink(options.socketPath.c_str());
+}
+
+void PuzzleDaemon::LoadPools() {
+  std::ifstream pooledFile{options.file};
+  // the pooled sudokus stay in the file until they are served
+  std::string line{};
+  while (std::getline(pooledFile, line)) {
+    auto sudoku{ParseLine(line, options.size)};
+    if (sudoku && pools[sudoku->first].size() < options.poolSize) {
+      pools[sudoku->first].emplace_back(std::move(sudoku->second));
+    }
+  }
+}
+
+void PuzzleDaemon::Persist(std::size_t poolIdx,
+                           const std::vector<SudokuValue> &values) {
+  try {
+    file->Append(values, Difficulties[poolIdx]);
+    file->Flush();
+  } catch (const std::runtime_error &) {
+    Log::Debug("unable to append a pooled sudoku to " + options.file);
+  }
+}
+
+void PuzzleDaemon::Unpersist(std::size_t poolIdx,
+                             const std::vector<SudokuValue> &values) {
+  std::ifstream pooledFile{options.file};
+  const auto tmpFile{options.file + ".tmp"};
+  std::ofstream rewritten{tmpFile, std::ios::trunc};
+  bool removed{};
+  std::string line{};
+  while (std::getline(pooledFile, line)) {
+    if (!removed) {
+      const auto sudoku{ParseLine(line, options.size)};
+      if (sudoku && sudoku->first == poolIdx && sudoku->second == values) {
+        removed = true;
+        continue;
+      }
+    }
+    rewritten << line << '\n';
+  }
+  rewritten.close();
+  // a short write (a full disk) must not replace the file
+  if (!removed || !rewritten || pooledFile.bad()) {
+    std::remove(tmpFile.c_str());
+    if (removed) {
+      Log::Debug("unable to remove a served sudoku from " + options.file);
+    }
+    return;
+  }
+  // a rename replaces the file at once
+  if (std::rename(tmpFile.c_str(), options.file.c_str()) != 0) {
+    std::remove(tmpFile.c_str());
+    Log::Debug("unable to replace " + options.file);
+    return;
+  }
+  // the appends went to the file that was replaced
+  file.emplace(options.file);
+}
+
+void PuzzleDaemon::Generate(std::stop_token stopToken,
+                            unsigned int threadIdx) {
+  SudokuGenerator sudokuGenerator{};
+  Generator generator{options.size, SectionSizeOf(options.size),
+                      options.maxGenerationTime, GeneratorTypes::Shift};
+  generator.targetClues = options.clues;
+  generator.digOrder = options.digOrder;
+  generator.minimal = options.minimal;
+  if (options.seed) {
+    generator.seed = *options.seed + threadIdx;
+  }
+  generator.stopToken = stopToken;
+
+  while (!stopToken.stop_requested()) {
+    std::size_t poolIdx{};
+    {
+      std::unique_lock lock{poolsMutex};
+      if (!taken.wait(lock, stopToken, [this]() { return !PoolsFull(); })) {
+        break;
+      }
+      poolIdx = NextPool();
+    }
+    generator.targetDifficulty = Difficulties[poolIdx];
+    const auto result{sudokuGenerator.Generate(generator)};
+    std::lock_guard lock{poolsMutex};
+    if (result != GenerateResult::Generated) {
+      // a difficulty the settings can't make leaves the others to generate
+      failures[poolIdx] = std::min(failures[poolIdx] + 1, MaxBackOff);
+      continue;
+    }
+    failures[poolIdx] = 0;
+    // another thread can have filled the pool in the meantime
+    if (pools[poolIdx].size() < options.poolSize) {
+      Persist(poolIdx, generator.values);
+      pools[poolIdx].emplace_back(generator.values);
+    }
+  }
+}
+
+void PuzzleDaemon::Serve(std::stop_token stopToken, int listenFd) {
+  while (!stopToken.stop_requested()) {
+    // wakes up now and then to see if the daemon stops
+    pollfd listening{listenFd, POLLIN, 0};
+    if (poll(&listening, 1, 200) <= 0) {
+      continue;
+    }
+    const auto fd{accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC)};
+    if (fd < 0) {
+      continue;
+    }
+    Answer(fd);
+    close(fd);
+  }
+}
+
+void PuzzleDaemon::Answer(int fd) {
+  // a client that stops talking can't hold up the others
+  const timeval timeout{1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  sudokuPool::Request request{};
+  std::vector<std::uint8_t> cells{};
+  while (sudokuPool::ReceiveAll(fd, &request, sizeof(request))) {
+    sudokuPool::ResponseHeader header{};
+    std::optional<sudokuPool::PooledSudoku> sudoku{};
+    if (request.version != sudokuPool::Version ||
+        request.size != options.size) {
+      header.status = sudokuPool::Status::Unsupported;
+    } else if (sudoku = Take(request.difficulty); !sudoku) {
+      header.status = sudokuPool::Status::Empty;
+    } else {
+      header.difficulty = static_cast<std::uint8_t>(sudoku->difficulty);
+      header.cells = static_cast<std::uint16_t>(sudoku->values.size());
+      cells.clear();
+      for (const auto &v : sudoku->values) {
+        cells.push_back(static_cast<std::uint8_t>(v.value_or(0)));
+      }
+    }
+    if (!sudokuPool::SendAll(fd, &header, sizeof(header)) ||
+        (sudoku && !sudokuPool::SendAll(fd, cells.data(), cells.size()))) {
+      break;
+    }
+  }
+}
+
+std::optional<sudokuPool::PooledSudoku>
+PuzzleDaemon::Take(std::uint8_t difficulty) {
+  std::optional<sudokuPool::PooledSudoku> sudoku{};
+  {
+    std::lock_guard lock{poolsMutex};
+    auto poolIdx{PoolIndexOf(difficulty)};
+    if (difficulty == sudokuPool::AnyDifficulty) {
+      poolIdx = static_cast<std::size_t>(
+          std::ranges::max_element(
+              pools, [](const auto &a, const auto &b) {
+                return a.size() < b.size();
+              }) -
+          pools.begin());
+    }
+    if (!poolIdx || pools[*poolIdx].empty()) {
+      return {};
+    }
+    sudoku.emplace(std::move(pools[*poolIdx].front()), Difficulties[*poolIdx]);
+    pools[*poolIdx].pop_front();
+    Unpersist(*poolIdx, sudoku->values);
+  }
+  taken.notify_all();
+  return sudoku;
+}
+
+bool PuzzleDaemon::PoolsFull() const noexcept {
+  return std::ranges::all_of(pools, [this](const auto &pool) {
+    return pool.size() >= options.poolSize;
+  });
+}
+
+std::size_t PuzzleDaemon::NextPool() noexcept {
+  while (true) {
+    const auto poolIdx{nextPool};
+    nextPool = (nextPool + 1) % pools.size();
+    if (pools[poolIdx].size() >= options.poolSize) {
+      continue;
+    }
+    if (passedOver[poolIdx] < failures[poolIdx]) {
+      passedOver[poolIdx]++;
+      continue;
+    }
+    passedOver[poolIdx] = 0;
+    return poolIdx;
+  }
+}